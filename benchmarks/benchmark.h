@@ -0,0 +1,168 @@
+//
+// Created by filipecn on 16/10/2026.
+//
+#ifndef ODYSSEUS_BENCHMARKS_BENCHMARK_H
+#define ODYSSEUS_BENCHMARKS_BENCHMARK_H
+
+#include <ponos/common/defs.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace odysseus::benchmark {
+
+/// Keeps the compiler from optimizing away a value (and the allocation that
+/// produced it)
+template<typename T>
+inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void *sink;
+  sink = &value;
+#endif
+}
+
+/// Measurements of a single benchmark configuration
+/// One operation is an allocation followed (later) by its release.
+struct Result {
+  std::string name;
+  u32 size{0};
+  u32 align{0};
+  u32 threads{0};
+  u64 operations{0};
+  /// wall time per operation, all threads combined
+  f64 ns_per_op{0};
+  /// operations per second, all threads combined (millions)
+  f64 mops{0};
+  /// per batch latency percentiles (ns per operation)
+  f64 p50_ns{0};
+  f64 p90_ns{0};
+  f64 p99_ns{0};
+  f64 max_ns{0};
+};
+
+/// Runs batches of operations in one or more threads and measures them
+/// \tparam F callable receiving the thread index and returning the batch
+/// callable of that thread
+/// \param name
+/// \param size block size in bytes
+/// \param align block alignment in bytes
+/// \param thread_count
+/// \param batch_count batches per thread
+/// \param operations_per_batch operations performed by each batch call
+/// \param make_batch
+/// \return
+template<class F>
+Result run(const std::string &name, u32 size, u32 align, u32 thread_count,
+           u32 batch_count, u32 operations_per_batch, F &&make_batch) {
+  using clock = std::chrono::steady_clock;
+  std::vector<std::vector<f64>> latencies(thread_count);
+  std::vector<clock::time_point> starts(thread_count), ends(thread_count);
+  std::atomic<u32> ready{0};
+  auto worker = [&](u32 thread_index) {
+    auto batch = make_batch(thread_index);
+    auto &latency = latencies[thread_index];
+    latency.reserve(batch_count);
+    // warm up caches and allocator state
+    for (u32 i = 0; i < std::max(batch_count / 16, 1u); ++i)
+      batch();
+    // all threads start measuring together
+    ready.fetch_add(1);
+    while (ready.load() < thread_count)
+      std::this_thread::yield();
+    starts[thread_index] = clock::now();
+    for (u32 i = 0; i < batch_count; ++i) {
+      auto start = clock::now();
+      batch();
+      std::chrono::duration<f64, std::nano> elapsed = clock::now() - start;
+      latency.emplace_back(elapsed.count() / operations_per_batch);
+    }
+    ends[thread_index] = clock::now();
+  };
+  std::vector<std::thread> threads;
+  for (u32 t = 1; t < thread_count; ++t)
+    threads.emplace_back(worker, t);
+  worker(0);
+  for (auto &thread : threads)
+    thread.join();
+  std::chrono::duration<f64, std::nano> elapsed =
+      *std::max_element(ends.begin(), ends.end()) - *std::min_element(starts.begin(), starts.end());
+
+  Result result;
+  result.name = name;
+  result.size = size;
+  result.align = align;
+  result.threads = thread_count;
+  result.operations = static_cast<u64>(thread_count) * batch_count * operations_per_batch;
+  result.ns_per_op = elapsed.count() / static_cast<f64>(result.operations);
+  result.mops = 1e3 / result.ns_per_op;
+  std::vector<f64> all;
+  for (auto &latency : latencies)
+    all.insert(all.end(), latency.begin(), latency.end());
+  std::sort(all.begin(), all.end());
+  auto percentile = [&](f64 p) {
+    return all[std::min(all.size() - 1, static_cast<std::size_t>(p * static_cast<f64>(all.size())))];
+  };
+  result.p50_ns = percentile(0.5);
+  result.p90_ns = percentile(0.9);
+  result.p99_ns = percentile(0.99);
+  result.max_ns = all.back();
+  return result;
+}
+
+/// Collection of results
+class Report {
+public:
+  ///
+  /// \param result
+  void add(const Result &result) {
+    results_.emplace_back(result);
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%-32s size %5u align %4u threads %2u | %8.2f ns/op %9.2f Mops/s | p50 %8.2f p99 %8.2f max %10.2f",
+                  result.name.c_str(), result.size, result.align, result.threads,
+                  result.ns_per_op, result.mops, result.p50_ns, result.p99_ns, result.max_ns);
+    std::cout << line << std::endl;
+  }
+  /// \return results in JSON
+  [[nodiscard]] std::string toJson() const {
+    std::string json = "{\n  \"benchmarks\": [";
+    char entry[512];
+    for (std::size_t i = 0; i < results_.size(); ++i) {
+      const auto &r = results_[i];
+      std::snprintf(entry, sizeof(entry),
+                    "%s\n    {\"name\": \"%s\", \"size\": %u, \"align\": %u, \"threads\": %u, "
+                    "\"operations\": %llu, \"ns_per_op\": %.3f, \"mops\": %.3f, "
+                    "\"p50_ns\": %.3f, \"p90_ns\": %.3f, \"p99_ns\": %.3f, \"max_ns\": %.3f}",
+                    i ? "," : "", r.name.c_str(), r.size, r.align, r.threads,
+                    static_cast<unsigned long long>(r.operations), r.ns_per_op, r.mops,
+                    r.p50_ns, r.p90_ns, r.p99_ns, r.max_ns);
+      json += entry;
+    }
+    json += "\n  ]\n}\n";
+    return json;
+  }
+  /// \param path
+  /// \return false if the file could not be written
+  bool save(const std::string &path) const {
+    std::ofstream file(path);
+    if (!file.good())
+      return false;
+    file << toJson();
+    return file.good();
+  }
+
+private:
+  std::vector<Result> results_;
+};
+
+}
+
+#endif //ODYSSEUS_BENCHMARKS_BENCHMARK_H
@@ -0,0 +1,309 @@
+//
+// Created by filipecn on 16/10/2026.
+//
+// Allocator micro-benchmarks
+//
+// usage: odysseus_benchmarks [output.json] [--quick]
+//
+// Every benchmark allocates a batch of blocks and then releases all of them.
+// Single threaded allocators get one instance per thread, thread safe ones
+// (malloc, new, mem::allocAligned, ConcurrentPoolAllocator) are shared.
+// Pools take their storage from the HEAP context because the general purpose
+// context is not thread safe.
+#include "benchmark.h"
+#include <odysseus/containers/object_pool.h>
+#include <odysseus/memory/concurrent_pool_allocator.h>
+#include <odysseus/memory/double_stack_allocator.h>
+#include <odysseus/memory/mem.h>
+#include <odysseus/memory/pool_allocator.h>
+#include <odysseus/memory/small_object_allocator.h>
+#include <odysseus/memory/stack_allocator.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+
+using namespace odysseus;
+using namespace odysseus::benchmark;
+
+namespace {
+
+constexpr u32 batch_size = 64;
+const u32 sizes[] = {16, 64, 256, 1024, 4096};
+const u32 aligns[] = {8, 64};
+const u32 thread_counts[] = {1, 2, 4, 8};
+// shared pools are also measured under heavy contention
+const u32 contention_thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+u32 batch_count = 20000;
+
+template<u32 S>
+struct Blob {
+  byte data[S];
+};
+
+void mallocBenchmarks(Report &report) {
+  for (auto size : sizes)
+    for (auto align : aligns)
+      for (auto threads : thread_counts) {
+        report.add(run("malloc", size, align, threads, batch_count, batch_size,
+                       [size, align](u32) {
+                         return [size, align]() {
+                           void *ptrs[batch_size];
+                           // aligned_alloc requires sizes multiple of the alignment
+                           const auto aligned_size = mem::alignTo(size, align);
+                           for (auto &ptr : ptrs) {
+                             ptr = align > alignof(std::max_align_t) ?
+                                   std::aligned_alloc(align, aligned_size) : std::malloc(size);
+                             doNotOptimize(ptr);
+                           }
+                           for (auto &ptr : ptrs)
+                             std::free(ptr);
+                         };
+                       }));
+        report.add(run("new", size, align, threads, batch_count, batch_size,
+                       [size, align](u32) {
+                         return [size, align]() {
+                           void *ptrs[batch_size];
+                           for (auto &ptr : ptrs) {
+                             ptr = ::operator new(size, std::align_val_t{align});
+                             doNotOptimize(ptr);
+                           }
+                           for (auto &ptr : ptrs)
+                             ::operator delete(ptr, std::align_val_t{align});
+                         };
+                       }));
+        report.add(run("mem::allocAligned", size, align, threads, batch_count, batch_size,
+                       [size, align](u32) {
+                         return [size, align]() {
+                           void *ptrs[batch_size];
+                           for (auto &ptr : ptrs) {
+                             ptr = mem::allocAligned(size, align);
+                             doNotOptimize(ptr);
+                           }
+                           for (auto &ptr : ptrs)
+                             mem::freeAligned(ptr);
+                         };
+                       }));
+      }
+}
+
+void stackBenchmarks(Report &report) {
+  for (auto size : sizes)
+    for (auto align : aligns)
+      for (auto threads : thread_counts) {
+        report.add(run("StackAllocator", size, align, threads, batch_count, batch_size,
+                       [size, align](u32) {
+                         auto stack = std::make_shared<StackAllocator>(batch_size * (size + align));
+                         return [stack, size, align]() {
+                           for (u32 i = 0; i < batch_size; ++i)
+                             doNotOptimize(stack->allocate(size, align));
+                           stack->clear();
+                         };
+                       }));
+        report.add(run("DoubleStackAllocator", size, align, threads, batch_count, batch_size,
+                       [size, align](u32) {
+                         auto stack = std::make_shared<DoubleStackAllocator>(batch_size * (size + align));
+                         return [stack, size, align]() {
+                           for (u32 i = 0; i < batch_size / 2; ++i) {
+                             doNotOptimize(stack->allocateLower(size, align));
+                             doNotOptimize(stack->allocateUpper(size, align));
+                           }
+                           stack->clear();
+                         };
+                       }));
+      }
+}
+
+void poolBenchmarks(Report &report) {
+  for (auto size : sizes)
+    for (auto threads : thread_counts) {
+      report.add(run("PoolAllocator", size, 8, threads, batch_count, batch_size,
+                     [size](u32) {
+                       auto pool = std::make_shared<PoolAllocator>(size, batch_size, mem::ContextType::HEAP);
+                       return [pool]() {
+                         void *ptrs[batch_size];
+                         for (auto &ptr : ptrs) {
+                           ptr = pool->allocate();
+                           doNotOptimize(ptr);
+                         }
+                         for (auto &ptr : ptrs)
+                           pool->freeObject(ptr);
+                       };
+                     }));
+      report.add(run("PoolAllocator::allocateBatch", size, 8, threads, batch_count, batch_size,
+                     [size](u32) {
+                       auto pool = std::make_shared<PoolAllocator>(size, batch_size, mem::ContextType::HEAP);
+                       return [pool]() {
+                         void *ptrs[batch_size];
+                         pool->allocateBatch(batch_size, ptrs);
+                         doNotOptimize(ptrs);
+                         pool->freeBatch(ptrs, batch_size);
+                       };
+                     }));
+    }
+}
+
+void concurrentPoolBenchmarks(Report &report) {
+  for (auto size : sizes)
+    for (auto threads : contention_thread_counts) {
+      auto shared_pool = std::make_shared<ConcurrentPoolAllocator>(size, batch_size * threads,
+                                                                   mem::ContextType::HEAP);
+      report.add(run("ConcurrentPoolAllocator", size, 8, threads, batch_count, batch_size,
+                     [shared_pool](u32) {
+                       return [shared_pool]() {
+                         void *ptrs[batch_size];
+                         for (auto &ptr : ptrs) {
+                           ptr = shared_pool->allocate();
+                           doNotOptimize(ptr);
+                         }
+                         for (auto &ptr : ptrs)
+                           shared_pool->freeObject(ptr);
+                       };
+                     }));
+      auto cached_pool = std::make_shared<ConcurrentPoolAllocator>(size, batch_size * threads,
+                                                                   mem::ContextType::HEAP, threads);
+      report.add(run("ConcurrentPoolAllocator::allocateCached", size, 8, threads, batch_count, batch_size,
+                     [cached_pool](u32 thread_index) {
+                       mem::setThreadIndex(thread_index);
+                       return [cached_pool]() {
+                         void *ptrs[batch_size];
+                         for (auto &ptr : ptrs) {
+                           ptr = cached_pool->allocateCached();
+                           doNotOptimize(ptr);
+                         }
+                         for (auto &ptr : ptrs)
+                           cached_pool->freeObjectCached(ptr);
+                       };
+                     }));
+    }
+}
+
+template<u32 S>
+void objectPoolBenchmark(Report &report) {
+  for (auto threads : thread_counts)
+    report.add(run("ObjectPool", S, alignof(Blob<S>), threads, batch_count, batch_size,
+                   [](u32) {
+                     auto pool = std::make_shared<ObjectPool<Blob<S>>>(batch_size, mem::ContextType::HEAP);
+                     return [pool]() {
+                       typename ObjectPool<Blob<S>>::Handle handles[batch_size];
+                       for (auto &handle : handles) {
+                         handle = pool->allocate();
+                         doNotOptimize(handle);
+                       }
+                       for (auto &handle : handles)
+                         pool->destroy(handle);
+                     };
+                   }));
+}
+
+void generalPurposeBenchmarks(Report &report) {
+  // TLSF context, not thread safe
+  for (auto size : sizes)
+    for (auto align : aligns)
+      report.add(run("mem::allocateBlock", size, align, 1, batch_count, batch_size,
+                     [size, align](u32) {
+                       return [size, align]() {
+                         void *ptrs[batch_size];
+                         for (auto &ptr : ptrs) {
+                           ptr = mem::allocateBlock(size, mem::ContextType::GENERAL_PURPOSE, align);
+                           doNotOptimize(ptr);
+                         }
+                         for (auto &ptr : ptrs)
+                           mem::freeBlock(ptr);
+                       };
+                     }));
+}
+
+/// Mixed size trace: blocks of 16 to 512 bytes (small sizes are more
+/// frequent) released in random order. Results use size 0 to mark mixed sizes.
+void smallObjectTraceBenchmarks(Report &report) {
+  struct Trace {
+    u32 sizes[batch_size];
+    u32 free_order[batch_size];
+  };
+  auto trace = std::make_shared<std::vector<Trace>>(64);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<u32> log_size(4, 9);
+  for (auto &t : *trace) {
+    for (u32 i = 0; i < batch_size; ++i) {
+      const u32 size_log2 = log_size(rng);
+      t.sizes[i] = std::uniform_int_distribution<u32>(1u << (size_log2 - 1), 1u << size_log2)(rng);
+      t.free_order[i] = i;
+    }
+    std::shuffle(t.free_order, t.free_order + batch_size, rng);
+  }
+  auto traceBatch = [trace](auto allocate, auto free) {
+    return [trace, allocate, free, t = 0u]() mutable {
+      const auto &entry = (*trace)[t++ % trace->size()];
+      void *ptrs[batch_size];
+      for (u32 i = 0; i < batch_size; ++i) {
+        ptrs[i] = allocate(entry.sizes[i]);
+        doNotOptimize(ptrs[i]);
+      }
+      for (auto i : entry.free_order)
+        free(ptrs[i]);
+    };
+  };
+  for (auto threads : thread_counts)
+    report.add(run("trace malloc", 0, 16, threads, batch_count, batch_size,
+                   [&](u32) {
+                     return traceBatch([](u32 size) { return std::malloc(size); },
+                                       [](void *ptr) { std::free(ptr); });
+                   }));
+  for (auto threads : thread_counts)
+    report.add(run("trace SmallObjectAllocator", 0, 16, threads, batch_count, batch_size,
+                   [&](u32) {
+                     auto allocator = std::make_shared<SmallObjectAllocator>(16 * SmallObjectAllocator::slab_size);
+                     return traceBatch([allocator](u32 size) { return allocator->allocate(size); },
+                                       [allocator](void *ptr) { allocator->freeBlock(ptr); });
+                   }));
+  // mem contexts are shared, so they run single threaded
+  report.add(run("trace mem SMALL_OBJECT", 0, 16, 1, batch_count, batch_size,
+                 [&](u32) {
+                   return traceBatch([](u32 size) {
+                                       return mem::allocateBlock(size, mem::ContextType::SMALL_OBJECT);
+                                     },
+                                     [](void *ptr) { mem::freeBlock(ptr); });
+                 }));
+  report.add(run("trace mem GENERAL_PURPOSE", 0, 16, 1, batch_count, batch_size,
+                 [&](u32) {
+                   return traceBatch([](u32 size) { return mem::allocateBlock(size); },
+                                     [](void *ptr) { mem::freeBlock(ptr); });
+                 }));
+}
+
+}
+
+int main(int argc, char **argv) {
+  std::string output = "odysseus_benchmarks.json";
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--quick") == 0)
+      batch_count = 1000;
+    else
+      output = argv[i];
+  }
+  mem::init(64 * 1024 * 1024);
+  mem::pushGeneralPurposeContext(32 * 1024 * 1024);
+  mem::pushSmallObjectContext(16 * 1024 * 1024);
+
+  Report report;
+  mallocBenchmarks(report);
+  stackBenchmarks(report);
+  poolBenchmarks(report);
+  concurrentPoolBenchmarks(report);
+  objectPoolBenchmark<16>(report);
+  objectPoolBenchmark<64>(report);
+  objectPoolBenchmark<256>(report);
+  objectPoolBenchmark<1024>(report);
+  objectPoolBenchmark<4096>(report);
+  generalPurposeBenchmarks(report);
+  smallObjectTraceBenchmarks(report);
+
+  if (!report.save(output)) {
+    std::cerr << "could not write " << output << std::endl;
+    return 1;
+  }
+  std::cout << "results written to " << output << std::endl;
+  return 0;
+}
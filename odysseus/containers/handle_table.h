@@ -0,0 +1,184 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file handle_table.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_CONTAINERS_HANDLE_TABLE_H
+#define ODYSSEUS_ODYSSEUS_CONTAINERS_HANDLE_TABLE_H
+
+#include <odysseus/memory/mem.h>
+#include <cstring>
+
+namespace odysseus {
+
+/// RAII Handle Table
+/// Maps generational handles to positions of a dense array, which is owned
+/// by the container using the table. Dense positions are always packed in
+/// [0, size): removing an element moves the last one into its place
+/// (swap-and-pop) and the table updates the moved element's entry.
+///
+/// \note Handles index a sparse table holding the current dense index of
+/// each live element. Free entries of the sparse table form a linked list.
+/// Each sparse entry has a generation counter (kept in its own array) that
+/// is incremented when an element is added and again when it is removed,
+/// so odd generations mark live entries and stale handles are detected in
+/// O(1), even if their entry was reused.
+class HandleTable {
+public:
+  /// Generational handle
+  struct Handle {
+    u32 index{0};
+    /// zero identifies an invalid handle
+    u32 generation{0};
+    [[nodiscard]] inline bool isValid() const { return generation != 0; }
+  };
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  /// \param context
+  explicit HandleTable(mem::ContextType context = mem::ContextType::GENERAL_PURPOSE) : context_{context} {}
+  ///
+  ~HandleTable() {
+    mem::freeBlock(dense_to_sparse_);
+    mem::freeBlock(sparse_);
+    mem::freeBlock(generations_);
+  }
+  HandleTable(const HandleTable &) = delete;
+  HandleTable &operator=(const HandleTable &) = delete;
+  /****************************************************************************
+                                    SIZE
+  ****************************************************************************/
+  /// \return number of live elements
+  [[nodiscard]] inline u32 size() const { return size_; }
+  /// \return maximum number of live elements
+  [[nodiscard]] inline u32 capacity() const { return capacity_; }
+  /// \return memory used by the table (in bytes)
+  [[nodiscard]] inline std::size_t sizeInBytes() const {
+    return static_cast<std::size_t>(capacity_) * 3 * sizeof(u32);
+  }
+  /// Increases the capacity. Handles and dense indices stay valid.
+  /// \param max_element_count
+  /// \return BAD_ALLOCATION if memory could not be allocated
+  OdResult reserve(u32 max_element_count) {
+    if (max_element_count <= capacity_)
+      return OdResult::SUCCESS;
+    auto *dense_to_sparse = reinterpret_cast<u32 *>(mem::allocateBlock(sizeof(u32) * max_element_count, context_));
+    auto *sparse = reinterpret_cast<u32 *>(mem::allocateBlock(sizeof(u32) * max_element_count, context_));
+    auto *generations = reinterpret_cast<u32 *>(mem::allocateBlock(sizeof(u32) * max_element_count, context_));
+    if (!dense_to_sparse || !sparse || !generations) {
+      mem::freeBlock(dense_to_sparse);
+      mem::freeBlock(sparse);
+      mem::freeBlock(generations);
+      return OdResult::BAD_ALLOCATION;
+    }
+    if (capacity_) {
+      std::memcpy(dense_to_sparse, dense_to_sparse_, sizeof(u32) * size_);
+      std::memcpy(sparse, sparse_, sizeof(u32) * capacity_);
+      std::memcpy(generations, generations_, sizeof(u32) * capacity_);
+    }
+    // new entries go to the front of the free list
+    for (u32 i = capacity_; i < max_element_count; ++i) {
+      sparse[i] = i + 1 < max_element_count ? i + 1 : free_head_;
+      generations[i] = 0;
+    }
+    free_head_ = capacity_;
+    mem::freeBlock(dense_to_sparse_);
+    mem::freeBlock(sparse_);
+    mem::freeBlock(generations_);
+    dense_to_sparse_ = dense_to_sparse;
+    sparse_ = sparse;
+    generations_ = generations;
+    capacity_ = max_element_count;
+    return OdResult::SUCCESS;
+  }
+  /****************************************************************************
+                                  OPERATIONS
+  ****************************************************************************/
+  /// Registers a new element at dense position size()
+  /// \return handle to the new element, an invalid handle if the table is full
+  Handle add() {
+    if (size_ >= capacity_)
+      return {};
+    const u32 index = free_head_;
+    free_head_ = sparse_[index];
+    sparse_[index] = size_;
+    dense_to_sparse_[size_++] = index;
+    return {index, ++generations_[index]};
+  }
+  /// Unregisters a live element. If it was not the last element, the
+  /// container must move its last element (at dense position size(), after
+  /// the call) into the returned position.
+  /// \param handle live handle
+  /// \return dense position of the removed element
+  u32 remove(Handle handle) {
+    ASSERT(isAlive(handle))
+    const u32 dense_index = sparse_[handle.index];
+    const u32 last = --size_;
+    if (dense_index != last) {
+      dense_to_sparse_[dense_index] = dense_to_sparse_[last];
+      sparse_[dense_to_sparse_[dense_index]] = dense_index;
+    }
+    sparse_[handle.index] = free_head_;
+    free_head_ = handle.index;
+    generations_[handle.index]++;
+    return dense_index;
+  }
+  /****************************************************************************
+                                    ACCESS
+  ****************************************************************************/
+  /// \param handle
+  /// \return true if handle refers to a live element
+  [[nodiscard]] inline bool isAlive(Handle handle) const {
+    return handle.index < capacity_ && (handle.generation & 1u) &&
+        generations_[handle.index] == handle.generation;
+  }
+  /// \param handle live handle
+  /// \return dense position of the element
+  [[nodiscard]] inline u32 denseIndex(Handle handle) const {
+    return sparse_[handle.index];
+  }
+  /// \param dense_index position of a live element in the dense array
+  /// \return handle of the element
+  [[nodiscard]] inline Handle handleAt(u32 dense_index) const {
+    const u32 index = dense_to_sparse_[dense_index];
+    return {index, generations_[index]};
+  }
+
+private:
+  // sparse index of each dense element
+  u32 *dense_to_sparse_{nullptr};
+  // dense index of live entries, next free entry for free entries
+  u32 *sparse_{nullptr};
+  u32 *generations_{nullptr};
+  u32 size_{0};
+  u32 capacity_{0};
+  // the free list ends with an invalid index
+  u32 free_head_{~0u};
+  mem::ContextType context_{mem::ContextType::GENERAL_PURPOSE};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_CONTAINERS_HANDLE_TABLE_H
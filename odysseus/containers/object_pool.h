@@ -33,7 +33,9 @@
 #ifndef ODYSSEUS_ODYSSEUS_CONTAINERS_OBJECT_POOL_H
 #define ODYSSEUS_ODYSSEUS_CONTAINERS_OBJECT_POOL_H
 
-#include <odysseus/memory/mem.h>
+#include <odysseus/containers/handle_table.h>
+#include <algorithm>
+#include <utility>
 
 namespace odysseus {
 
@@ -42,41 +44,145 @@ namespace odysseus {
 /// any order while still providing fast iteration to them.
 /// The pool has a limit number of active objects it can hold that can be
 /// increased at the cost of memory copies and possible allocations.
-/// \tparam O
+///
+/// \note Live objects are packed contiguously in a dense array, so iterating
+/// over them streams linearly through memory. Destroying an object moves the
+/// last object into its place (swap-and-pop), so object addresses and order
+/// are not stable. Objects are referenced through generational handles
+/// (see HandleTable), which can be safely cached across frames.
+/// \tparam O object type, must be move constructible
 template<typename O>
 class ObjectPool {
 public:
-  struct Handle {
-    u32 index;
-  };
+  using Handle = HandleTable::Handle;
   /****************************************************************************
                                  CONSTRUCTORS
   ****************************************************************************/
   ///
   /// \param max_object_count
   /// \param context
-  explicit ObjectPool(u32 max_object_count, mem::ContextType context = mem::ContextType::HEAP) {
-    std::size_t size_in_bytes = max_object_count * sizeof(u32);
-
-
+  explicit ObjectPool(u32 max_object_count, mem::ContextType context = mem::ContextType::GENERAL_PURPOSE)
+      : table_{context}, context_{context} {
+    reserve(max_object_count);
+  }
+  ///
+  ~ObjectPool() {
+    clear();
+    mem::freeBlock(objects_);
   }
+  ObjectPool(const ObjectPool &) = delete;
+  ObjectPool &operator=(const ObjectPool &) = delete;
   /****************************************************************************
                                     SIZE
   ****************************************************************************/
   ///
-  /// \return
-  [[nodiscard]] u32 sizeInBytes() const {}
-  [[nodiscard]] u32 capacity() const {}
+  /// \return total memory used by objects and tables (in bytes)
+  [[nodiscard]] std::size_t sizeInBytes() const {
+    return static_cast<std::size_t>(capacity()) * sizeof(O) + table_.sizeInBytes();
+  }
+  /// \return maximum number of live objects
+  [[nodiscard]] u32 capacity() const { return table_.capacity(); }
+  /// \return number of live objects
+  [[nodiscard]] u32 size() const { return table_.size(); }
+  /// Increases the capacity, moving all objects to new storage. Handles stay
+  /// valid, pointers to objects don't.
+  /// \param max_object_count
+  /// \return BAD_ALLOCATION if memory could not be allocated
+  OdResult reserve(u32 max_object_count) {
+    if (max_object_count <= capacity())
+      return OdResult::SUCCESS;
+    auto *objects = reinterpret_cast<O *>(mem::allocateBlock(
+        sizeof(O) * max_object_count, context_, std::max<std::size_t>(alignof(O), mem::cache_l1_size)));
+    if (!objects)
+      return OdResult::BAD_ALLOCATION;
+    auto result = table_.reserve(max_object_count);
+    if (result != OdResult::SUCCESS) {
+      mem::freeBlock(objects);
+      return result;
+    }
+    for (u32 i = 0; i < size(); ++i) {
+      new(objects + i) O(std::move(objects_[i]));
+      objects_[i].~O();
+    }
+    mem::freeBlock(objects_);
+    objects_ = objects;
+    return OdResult::SUCCESS;
+  }
 
   /****************************************************************************
                                     ALLOCATION
   ****************************************************************************/
+  /// Constructs a new object at the end of the dense array
+  /// \tparam P
+  /// \param params constructor parameters
+  /// \return handle to the new object, an invalid handle if the pool is full
   template<class... P>
   Handle allocate(P &&... params) {
-    //
+    if (size() >= capacity())
+      return {};
+    new(objects_ + size()) O(std::forward<P>(params)...);
+    return table_.add();
+  }
+  /// Destroys the object, moving the last object into its place
+  /// \param handle
+  /// \return INVALID_INPUT if the handle is stale
+  OdResult destroy(Handle handle) {
+    if (!table_.isAlive(handle))
+      return OdResult::INVALID_INPUT;
+    const u32 dense_index = table_.remove(handle);
+    const u32 last = size();
+    objects_[dense_index].~O();
+    if (dense_index != last) {
+      new(objects_ + dense_index) O(std::move(objects_[last]));
+      objects_[last].~O();
+    }
+    return OdResult::SUCCESS;
   }
+  /// Destroys all objects
+  void clear() {
+    while (size())
+      destroy(table_.handleAt(size() - 1));
+  }
+  /****************************************************************************
+                                    ACCESS
+  ****************************************************************************/
+  /// \param handle
+  /// \return true if handle refers to a live object
+  [[nodiscard]] bool isAlive(Handle handle) const {
+    return table_.isAlive(handle);
+  }
+  /// \param handle
+  /// \return pointer to the object, nullptr if the handle is stale
+  O *get(Handle handle) {
+    return table_.isAlive(handle) ? objects_ + table_.denseIndex(handle) : nullptr;
+  }
+  /// \param handle
+  /// \return pointer to the object, nullptr if the handle is stale
+  const O *get(Handle handle) const {
+    return table_.isAlive(handle) ? objects_ + table_.denseIndex(handle) : nullptr;
+  }
+  /// \param dense_index position of a live object in the dense array
+  /// \return handle of the object
+  [[nodiscard]] Handle handleAt(u32 dense_index) const {
+    return table_.handleAt(dense_index);
+  }
+  /// \return pointer to the first live object
+  O *data() { return objects_; }
+  const O *data() const { return objects_; }
+  O &operator[](u32 dense_index) { return objects_[dense_index]; }
+  const O &operator[](u32 dense_index) const { return objects_[dense_index]; }
+  /****************************************************************************
+                                  ITERATION
+  ****************************************************************************/
+  O *begin() { return objects_; }
+  O *end() { return objects_ + size(); }
+  const O *begin() const { return objects_; }
+  const O *end() const { return objects_ + size(); }
 
 private:
+  HandleTable table_;
+  O *objects_{nullptr};
+  mem::ContextType context_{mem::ContextType::GENERAL_PURPOSE};
 };
 
 }
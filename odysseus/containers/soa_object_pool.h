@@ -0,0 +1,235 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file soa_object_pool.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_CONTAINERS_SOA_OBJECT_POOL_H
+#define ODYSSEUS_ODYSSEUS_CONTAINERS_SOA_OBJECT_POOL_H
+
+#include <odysseus/containers/handle_table.h>
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace odysseus {
+
+/// Contiguous view over one field array of a SoAObjectPool
+/// \tparam T field type
+template<typename T>
+struct FieldSpan {
+  T *data{nullptr};
+  u32 size{0};
+  inline T *begin() const { return data; }
+  inline T *end() const { return data + size; }
+  inline T &operator[](u32 i) const { return data[i]; }
+};
+
+/// Structure-of-Arrays Object Pool
+/// Same semantics as ObjectPool, but each field of the objects lives in its
+/// own dense array. Loops that touch only a few fields stream through just
+/// those arrays, and each array is a plain contiguous sequence of scalars that
+/// compilers can vectorize.
+///
+/// \note All field arrays share a single block. Each array starts at a
+/// mem::cache_l1_size boundary and the capacity is rounded up to a multiple
+/// of simd_width elements, so SIMD loops may process full lanes past size()
+/// without leaving the array. Fields must be trivially copyable, which lets
+/// swap-and-pop and growth use plain memory copies.
+/// \tparam Fields field types, in declaration order
+template<typename... Fields>
+class SoAObjectPool {
+  static_assert(sizeof...(Fields) > 0, "SoAObjectPool needs at least one field");
+  static_assert((std::is_trivially_copyable_v<Fields> && ...),
+                "SoAObjectPool fields must be trivially copyable");
+public:
+  using Handle = HandleTable::Handle;
+  static constexpr std::size_t field_count = sizeof...(Fields);
+  /// capacity granularity (in elements)
+  static constexpr u32 simd_width = 16;
+  template<std::size_t I>
+  using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  ///
+  /// \param max_object_count
+  /// \param context
+  explicit SoAObjectPool(u32 max_object_count, mem::ContextType context = mem::ContextType::GENERAL_PURPOSE)
+      : table_{context}, context_{context} {
+    reserve(max_object_count);
+  }
+  ///
+  ~SoAObjectPool() {
+    mem::freeBlock(block_);
+  }
+  SoAObjectPool(const SoAObjectPool &) = delete;
+  SoAObjectPool &operator=(const SoAObjectPool &) = delete;
+  /****************************************************************************
+                                    SIZE
+  ****************************************************************************/
+  /// \return total memory used by field arrays and tables (in bytes)
+  [[nodiscard]] std::size_t sizeInBytes() const {
+    return blockSizeInBytes(capacity_) + table_.sizeInBytes();
+  }
+  /// \return maximum number of live objects
+  [[nodiscard]] u32 capacity() const { return capacity_; }
+  /// \return number of live objects
+  [[nodiscard]] u32 size() const { return table_.size(); }
+  /// Increases the capacity, copying all fields to new storage. Handles stay
+  /// valid, spans and pointers don't.
+  /// \param max_object_count
+  /// \return BAD_ALLOCATION if memory could not be allocated
+  OdResult reserve(u32 max_object_count) {
+    if (max_object_count <= capacity_)
+      return OdResult::SUCCESS;
+    const u32 capacity = (max_object_count + simd_width - 1) / simd_width * simd_width;
+    auto *block = reinterpret_cast<byte *>(mem::allocateBlock(blockSizeInBytes(capacity), context_, blockAlignment()));
+    if (!block)
+      return OdResult::BAD_ALLOCATION;
+    auto result = table_.reserve(capacity);
+    if (result != OdResult::SUCCESS) {
+      mem::freeBlock(block);
+      return result;
+    }
+    std::memset(block, 0, blockSizeInBytes(capacity));
+    std::size_t offset = 0;
+    std::size_t i = 0;
+    // fields are laid out in declaration order, each at an aligned offset
+    ((fields_[i] = block + offset,
+        offset += arraySizeInBytes(sizeof(Fields), capacity),
+        ++i), ...);
+    if (block_) {
+      offset = 0;
+      i = 0;
+      ((std::memcpy(fields_[i], block_ + offset, sizeof(Fields) * size()),
+          offset += arraySizeInBytes(sizeof(Fields), capacity_),
+          ++i), ...);
+      mem::freeBlock(block_);
+    }
+    block_ = block;
+    capacity_ = capacity;
+    return OdResult::SUCCESS;
+  }
+  /****************************************************************************
+                                    ALLOCATION
+  ****************************************************************************/
+  /// Appends a new object
+  /// \param values one value per field
+  /// \return handle to the new object, an invalid handle if the pool is full
+  Handle allocate(const Fields &... values) {
+    if (size() >= capacity_)
+      return {};
+    const u32 dense_index = size();
+    std::size_t i = 0;
+    ((reinterpret_cast<Fields *>(fields_[i++])[dense_index] = values), ...);
+    return table_.add();
+  }
+  /// Destroys the object, moving the last object into its place
+  /// \param handle
+  /// \return INVALID_INPUT if the handle is stale
+  OdResult destroy(Handle handle) {
+    if (!table_.isAlive(handle))
+      return OdResult::INVALID_INPUT;
+    const u32 dense_index = table_.remove(handle);
+    const u32 last = size();
+    if (dense_index != last) {
+      std::size_t i = 0;
+      ((reinterpret_cast<Fields *>(fields_[i])[dense_index] = reinterpret_cast<Fields *>(fields_[i])[last],
+          ++i), ...);
+    }
+    return OdResult::SUCCESS;
+  }
+  /// Destroys all objects
+  void clear() {
+    while (size())
+      table_.remove(table_.handleAt(size() - 1));
+  }
+  /****************************************************************************
+                                    ACCESS
+  ****************************************************************************/
+  /// \param handle
+  /// \return true if handle refers to a live object
+  [[nodiscard]] bool isAlive(Handle handle) const {
+    return table_.isAlive(handle);
+  }
+  /// \param dense_index position of a live object in the dense arrays
+  /// \return handle of the object
+  [[nodiscard]] Handle handleAt(u32 dense_index) const {
+    return table_.handleAt(dense_index);
+  }
+  /// \tparam I field index
+  /// \return span over the live values of field I
+  template<std::size_t I>
+  FieldSpan<FieldType<I>> field() {
+    return {fieldData<I>(), size()};
+  }
+  /// \tparam I field index
+  /// \return span over the live values of field I
+  template<std::size_t I>
+  FieldSpan<const FieldType<I>> field() const {
+    return {fieldData<I>(), size()};
+  }
+  /// \tparam I field index
+  /// \param handle
+  /// \return pointer to the field value of the object, nullptr if the handle is stale
+  template<std::size_t I>
+  FieldType<I> *get(Handle handle) {
+    return table_.isAlive(handle) ? fieldData<I>() + table_.denseIndex(handle) : nullptr;
+  }
+  /// \tparam I field index
+  /// \param handle
+  /// \return pointer to the field value of the object, nullptr if the handle is stale
+  template<std::size_t I>
+  const FieldType<I> *get(Handle handle) const {
+    return table_.isAlive(handle) ? fieldData<I>() + table_.denseIndex(handle) : nullptr;
+  }
+
+private:
+  static std::size_t blockAlignment() {
+    return std::max({static_cast<std::size_t>(mem::cache_l1_size), alignof(Fields)...});
+  }
+  static std::size_t arraySizeInBytes(std::size_t field_size, u32 capacity) {
+    return mem::alignTo(field_size * capacity, blockAlignment());
+  }
+  static std::size_t blockSizeInBytes(u32 capacity) {
+    return (arraySizeInBytes(sizeof(Fields), capacity) + ... + 0);
+  }
+  template<std::size_t I>
+  FieldType<I> *fieldData() const {
+    return reinterpret_cast<FieldType<I> *>(fields_[I]);
+  }
+
+  HandleTable table_;
+  byte *block_{nullptr};
+  byte *fields_[field_count]{};
+  u32 capacity_{0};
+  mem::ContextType context_{mem::ContextType::GENERAL_PURPOSE};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_CONTAINERS_SOA_OBJECT_POOL_H
@@ -0,0 +1,169 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file work_stealing_deque.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_CONTAINERS_WORK_STEALING_DEQUE_H
+#define ODYSSEUS_ODYSSEUS_CONTAINERS_WORK_STEALING_DEQUE_H
+
+#include <odysseus/memory/mem.h>
+#include <atomic>
+#include <type_traits>
+
+namespace odysseus {
+
+/// RAII Chase-Lev Work-Stealing Deque
+/// A bounded single-producer multi-consumer deque. The owner thread pushes
+/// and pops items at the bottom (LIFO, so it keeps working on hot data)
+/// while any other thread steals items from the top (FIFO, so thieves get
+/// the oldest and usually largest pieces of work).
+///
+/// \note Only the owner synchronizes with thieves, and only when a single
+/// item is left (a compare-and-swap on top). Pushes and pops of the owner
+/// are otherwise plain loads and stores.
+/// \note The capacity is fixed (rounded up to a power of two), push fails
+/// when the deque is full instead of growing the buffer.
+/// \note Follows the C11 formulation of Lê, Pop, Cohen and Zappa Nardelli,
+/// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+/// \tparam T trivially copyable item type (usually a pointer)
+template<typename T>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque items must be trivially copyable");
+public:
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  WorkStealingDeque() = default;
+  /// \param capacity maximum number of items (rounded up to a power of two)
+  /// \param context memory context the buffer is allocated from
+  explicit WorkStealingDeque(u32 capacity,
+                             mem::ContextType context = mem::ContextType::GENERAL_PURPOSE) {
+    u32 size = 1;
+    while (size < capacity)
+      size <<= 1u;
+    buffer_ = reinterpret_cast<std::atomic<T> *>(
+        mem::allocateBlock(sizeof(std::atomic<T>) * size, context, alignof(std::atomic<T>)));
+    if (!buffer_)
+      return;
+    for (u32 i = 0; i < size; ++i)
+      new(buffer_ + i) std::atomic<T>();
+    mask_ = size - 1;
+  }
+  ~WorkStealingDeque() {
+    mem::freeBlock(buffer_);
+  }
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+  /****************************************************************************
+                                    SIZE
+  ****************************************************************************/
+  /// \return maximum number of items
+  [[nodiscard]] u32 capacity() const { return buffer_ ? mask_ + 1 : 0; }
+  /// \note The value may be outdated while other threads are operating.
+  /// \return number of items
+  [[nodiscard]] u32 size() const {
+    const i64 b = bottom_.load(std::memory_order_seq_cst);
+    const i64 t = top_.load(std::memory_order_seq_cst);
+    return b > t ? static_cast<u32>(b - t) : 0;
+  }
+  /// \note The value may be outdated while other threads are operating.
+  /// \return true if there are no items
+  [[nodiscard]] bool empty() const { return size() == 0; }
+  /****************************************************************************
+                                    OWNER
+  ****************************************************************************/
+  /// Pushes an item to the bottom
+  /// \note Owner thread only.
+  /// \param item
+  /// \return false if the deque is full
+  bool push(T item) {
+    const i64 b = bottom_.load(std::memory_order_relaxed);
+    const i64 t = top_.load(std::memory_order_acquire);
+    if (!buffer_ || b - t > static_cast<i64>(mask_))
+      return false;
+    buffer_[b & mask_].store(item, std::memory_order_relaxed);
+    // release: thieves that see the new bottom also see the item (and
+    // everything written before pushing it)
+    bottom_.store(b + 1, std::memory_order_release);
+    return true;
+  }
+  /// Pops the most recently pushed item
+  /// \note Owner thread only.
+  /// \param item receives the item
+  /// \return false if the deque is empty (or a thief took the last item)
+  bool pop(T &item) {
+    const i64 b = bottom_.load(std::memory_order_relaxed) - 1;
+    // the bottom store must be ordered before the top load, so that a
+    // concurrent thief and the owner can't both take the last item
+    bottom_.store(b, std::memory_order_seq_cst);
+    i64 t = top_.load(std::memory_order_seq_cst);
+    if (t > b) {
+      // empty
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    item = buffer_[b & mask_].load(std::memory_order_relaxed);
+    if (t == b) {
+      // last item, race thieves for it
+      const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+  /****************************************************************************
+                                    THIEVES
+  ****************************************************************************/
+  /// Steals the oldest item
+  /// \note Any thread.
+  /// \param item receives the item
+  /// \return false if the deque is empty or another thread won the item
+  bool steal(T &item) {
+    i64 t = top_.load(std::memory_order_seq_cst);
+    const i64 b = bottom_.load(std::memory_order_seq_cst);
+    if (t >= b)
+      return false;
+    // the slot may be overwritten by the owner once top moves, in which
+    // case the compare-and-swap below fails and the value is discarded
+    const T stolen = buffer_[t & mask_].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed))
+      return false;
+    item = stolen;
+    return true;
+  }
+
+private:
+  // top is written by thieves and bottom by the owner, keep them apart
+  alignas(64) std::atomic<i64> top_{0};
+  alignas(64) std::atomic<i64> bottom_{0};
+  alignas(64) std::atomic<T> *buffer_{nullptr};
+  u32 mask_{0};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_CONTAINERS_WORK_STEALING_DEQUE_H
@@ -37,9 +37,9 @@
 /****************************************************************************
                              DEBUG MODE
 ****************************************************************************/
-#ifndef ODYSSEUS_DEBUG
-#define ODYSSEUS_DEBUG
-#endif
+// ODYSSEUS_DEBUG is defined by the build system for Debug configurations.
+// It enables memory dumps and selects RegionTracking as the default
+// allocation tracking policy (see memory/allocation_tracking.h).
 
 #ifdef ODYSSEUS_DEBUG
 #define ODYSSEUS_DEBUG_CODE(CODE_CONTENT) {CODE_CONTENT}
@@ -0,0 +1,159 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file profiler.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/debug/profiler.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace odysseus {
+
+thread_local u32 Profiler::depth_ = 0;
+
+OdResult Profiler::init(u32 thread_count, u32 events_per_thread, mem::ContextType context) {
+  release();
+  auto &instance = get();
+  const auto event_count = mem::nextPowerOfTwo(std::max(events_per_thread, 1u));
+  auto *buffers = reinterpret_cast<ThreadBuffer *>(
+      mem::allocateBlock(sizeof(ThreadBuffer) * thread_count, context, alignof(ThreadBuffer)));
+  if (!buffers)
+    return OdResult::BAD_ALLOCATION;
+  for (u32 i = 0; i < thread_count; ++i) {
+    new(buffers + i) ThreadBuffer();
+    buffers[i].events = reinterpret_cast<Event *>(
+        mem::allocateBlock(sizeof(Event) * event_count, context, mem::cache_l1_size));
+    if (!buffers[i].events) {
+      instance.buffers_ = buffers;
+      instance.thread_count_ = i + 1;
+      release();
+      return OdResult::BAD_ALLOCATION;
+    }
+  }
+  calibrate();
+  instance.event_mask_ = event_count - 1;
+  instance.buffers_ = buffers;
+  instance.thread_count_ = thread_count;
+  return OdResult::SUCCESS;
+}
+
+void Profiler::release() {
+  auto &instance = get();
+  for (u32 i = 0; i < instance.thread_count_; ++i) {
+    mem::freeBlock(instance.buffers_[i].events);
+    instance.buffers_[i].~ThreadBuffer();
+  }
+  mem::freeBlock(instance.buffers_);
+  instance.buffers_ = nullptr;
+  instance.thread_count_ = 0;
+  instance.event_mask_ = 0;
+}
+
+void Profiler::calibrate(u32 milliseconds) {
+#ifdef ODYSSEUS_HAS_RDTSC
+  const auto clock_begin = std::chrono::steady_clock::now();
+  const u64 ticks_begin = ticks();
+  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+  const u64 ticks_end = ticks();
+  const auto clock_end = std::chrono::steady_clock::now();
+  const f64 us = std::chrono::duration<f64, std::micro>(clock_end - clock_begin).count();
+  if (us > 0 && ticks_end > ticks_begin)
+    get().ticks_per_us_ = static_cast<f64>(ticks_end - ticks_begin) / us;
+#else
+  UNUSED(milliseconds);
+  get().ticks_per_us_ = 1000.;
+#endif
+}
+
+void Profiler::reset() {
+  auto &instance = get();
+  for (u32 i = 0; i < instance.thread_count_; ++i)
+    instance.buffers_[i].head.store(0, std::memory_order_release);
+}
+
+f64 Profiler::ticksPerMicrosecond() {
+  return get().ticks_per_us_;
+}
+
+u32 Profiler::eventCount(u32 thread) {
+  auto &instance = get();
+  if (thread >= instance.thread_count_)
+    return 0;
+  const u64 head = instance.buffers_[thread].head.load(std::memory_order_acquire);
+  return static_cast<u32>(std::min(head, instance.event_mask_ + 1));
+}
+
+Profiler::Event Profiler::event(u32 thread, u32 i) {
+  auto &instance = get();
+  const u64 head = instance.buffers_[thread].head.load(std::memory_order_acquire);
+  const u64 first = head - eventCount(thread);
+  return instance.buffers_[thread].events[(first + i) & instance.event_mask_];
+}
+
+std::string Profiler::chromeTrace() {
+  auto &instance = get();
+  // timestamps are exported relative to the oldest stored event
+  u64 origin = ~0ull;
+  for (u32 t = 0; t < instance.thread_count_; ++t)
+    for (u32 i = 0, n = eventCount(t); i < n; ++i)
+      origin = std::min(origin, event(t, i).begin);
+  std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  char numbers[128];
+  for (u32 t = 0; t < instance.thread_count_; ++t)
+    for (u32 i = 0, n = eventCount(t); i < n; ++i) {
+      const auto e = event(t, i);
+      json += first ? "\n{\"name\":\"" : ",\n{\"name\":\"";
+      first = false;
+      for (const char *c = e.name; c && *c; ++c) {
+        if (*c == '"' || *c == '\\')
+          json += '\\';
+        if (static_cast<unsigned char>(*c) >= 0x20)
+          json += *c;
+      }
+      std::snprintf(numbers, sizeof(numbers),
+                    "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%u}}",
+                    t,
+                    static_cast<f64>(e.begin - origin) / instance.ticks_per_us_,
+                    static_cast<f64>(e.end - e.begin) / instance.ticks_per_us_,
+                    e.depth);
+      json += numbers;
+    }
+  json += "\n]}\n";
+  return json;
+}
+
+OdResult Profiler::saveChromeTrace(const std::string &path) {
+  std::ofstream file(path);
+  if (!file.good())
+    return OdResult::INVALID_INPUT;
+  file << chromeTrace();
+  return file.good() ? OdResult::SUCCESS : OdResult::INVALID_INPUT;
+}
+
+}
@@ -0,0 +1,197 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file profiler.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_DEBUG_PROFILER_H
+#define ODYSSEUS_ODYSSEUS_DEBUG_PROFILER_H
+
+#include <odysseus/memory/mem.h>
+#include <atomic>
+#include <string>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#define ODYSSEUS_HAS_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+namespace odysseus {
+
+/// Instrumented CPU Profiler Singleton
+/// Scoped zones (see ProfileZone and ODYSSEUS_PROFILE_ZONE) record their
+/// begin/end timestamps into a ring buffer owned by the calling thread. The
+/// recorded events can be exported to the Chrome trace JSON format, which
+/// is also loaded by Perfetto (ui.perfetto.dev) and chrome://tracing.
+///
+/// \note Timestamps come from the CPU time stamp counter (rdtsc) when
+/// available, and are converted to microseconds with the ratio measured by
+/// calibrate(). Other architectures use std::chrono::steady_clock.
+/// \note Threads are identified by mem::threadIndex(). Each thread writes
+/// only its own ring buffer, so recording needs no locks or atomic
+/// read-modify-write operations. When a buffer is full the oldest events
+/// are overwritten. Exporting while threads are recording may read events
+/// that are being overwritten, export between frames instead.
+/// \note Zones recorded before init() or from threads with an index beyond
+/// the initialized thread count are ignored.
+class Profiler {
+public:
+  /// Recorded zone
+  struct Event {
+    /// zone name, must outlive the profiler (usually a string literal)
+    const char *name;
+    u64 begin;
+    u64 end;
+    /// nesting level of the zone in its thread
+    u32 depth;
+  };
+  /****************************************************************************
+                                 INITIALIZATION
+  ****************************************************************************/
+  /// Allocates one ring buffer per thread and calibrates the clock.
+  /// Previous events are discarded.
+  /// \param thread_count number of threads that may record zones
+  /// \param events_per_thread ring buffer capacity, rounded up to a power of two
+  /// \param context memory context the ring buffers are allocated from
+  /// \return BAD_ALLOCATION if buffers could not be allocated
+  static OdResult init(u32 thread_count, u32 events_per_thread,
+                       mem::ContextType context = mem::ContextType::GENERAL_PURPOSE);
+  /// Frees all ring buffers
+  /// \note Must be called before the memory context used in init is
+  /// destroyed, the profiler doesn't free its buffers on exit.
+  static void release();
+  /// Measures the tick rate of ticks()
+  /// \param milliseconds measurement period
+  static void calibrate(u32 milliseconds = 10);
+  /// Discards all recorded events
+  static void reset();
+  /****************************************************************************
+                                  RECORDING
+  ****************************************************************************/
+  /// \return current timestamp (in ticks)
+  static inline u64 ticks() {
+#ifdef ODYSSEUS_HAS_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+  }
+  /// \return ticks per microsecond measured by calibrate()
+  static f64 ticksPerMicrosecond();
+  /// Records a zone in the ring buffer of the calling thread
+  /// \param name
+  /// \param begin
+  /// \param end
+  /// \param depth
+  static inline void record(const char *name, u64 begin, u64 end, u32 depth) {
+    auto &instance = get();
+    const u32 thread = mem::threadIndex();
+    if (thread >= instance.thread_count_)
+      return;
+    auto &buffer = instance.buffers_[thread];
+    const u64 head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head & instance.event_mask_] = {name, begin, end, depth};
+    buffer.head.store(head + 1, std::memory_order_release);
+  }
+  /// \return nesting level of the calling thread
+  static inline u32 &depth() { return depth_; }
+  /****************************************************************************
+                                   QUERIES
+  ****************************************************************************/
+  /// \param thread thread index
+  /// \return number of events currently stored for the thread
+  static u32 eventCount(u32 thread);
+  /// \param thread thread index
+  /// \param i event index, from the oldest (0) to the newest stored event
+  /// \return recorded event
+  static Event event(u32 thread, u32 i);
+  /****************************************************************************
+                                   EXPORT
+  ****************************************************************************/
+  /// \return all stored events as a Chrome trace JSON document
+  static std::string chromeTrace();
+  /// Writes chromeTrace() into a file
+  /// \param path
+  /// \return INVALID_INPUT if the file could not be written
+  static OdResult saveChromeTrace(const std::string &path);
+
+  Profiler &operator=(const Profiler &) = delete;
+
+private:
+  struct alignas(64) ThreadBuffer {
+    std::atomic<u64> head{0};
+    Event *events{nullptr};
+  };
+
+  Profiler() = default;
+  static inline Profiler &get() {
+    static Profiler singleton;
+    return singleton;
+  }
+
+  ThreadBuffer *buffers_{nullptr};
+  u32 thread_count_{0};
+  u64 event_mask_{0};
+  f64 ticks_per_us_{1000.};
+  static thread_local u32 depth_;
+};
+
+/// Scoped profiler zone
+/// Records the time between its construction and destruction.
+class ProfileZone {
+public:
+  /// \param name zone name, must outlive the profiler (usually a string literal)
+  explicit ProfileZone(const char *name) : name_{name}, depth_{Profiler::depth()++},
+                                           begin_{Profiler::ticks()} {}
+  ~ProfileZone() {
+    const u64 end = Profiler::ticks();
+    --Profiler::depth();
+    Profiler::record(name_, begin_, end, depth_);
+  }
+  ProfileZone(const ProfileZone &) = delete;
+  ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+  const char *name_;
+  u32 depth_;
+  u64 begin_;
+};
+
+}
+
+#define ODYSSEUS_PROFILE_CONCAT_IMPL(A, B) A##B
+#define ODYSSEUS_PROFILE_CONCAT(A, B) ODYSSEUS_PROFILE_CONCAT_IMPL(A, B)
+/// Profiles the enclosing scope
+#define ODYSSEUS_PROFILE_ZONE(NAME) \
+  odysseus::ProfileZone ODYSSEUS_PROFILE_CONCAT(odysseus_profile_zone_, __LINE__)(NAME)
+/// Profiles the enclosing function
+#define ODYSSEUS_PROFILE_FUNCTION() ODYSSEUS_PROFILE_ZONE(__func__)
+
+#endif //ODYSSEUS_ODYSSEUS_DEBUG_PROFILER_H
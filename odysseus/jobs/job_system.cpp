@@ -0,0 +1,287 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file job_system.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/jobs/job_system.h>
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace odysseus {
+
+namespace {
+
+/// number of failed job searches before an idle worker goes to sleep
+constexpr u32 idle_spin_count = 64;
+
+#ifdef __linux__
+/// affinity of the thread that called init, restored by release
+cpu_set_t caller_affinity;
+bool caller_pinned = false;
+
+void pinThread(pthread_t thread, u32 worker_index) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(worker_index % std::max(1u, std::thread::hardware_concurrency()), &cpu_set);
+  pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpu_set);
+}
+#endif
+
+}
+
+OdResult JobSystem::init(u32 worker_count, std::size_t scratch_size_in_bytes,
+                         u32 jobs_per_worker, bool pin_workers, mem::ContextType context) {
+  release();
+  if (!worker_count)
+    worker_count = std::max(1u, std::thread::hardware_concurrency());
+  auto &instance = get();
+  // job records
+  auto *jobs = reinterpret_cast<ConcurrentPoolAllocator *>(
+      mem::allocateBlock(sizeof(ConcurrentPoolAllocator), context, alignof(ConcurrentPoolAllocator)));
+  if (!jobs)
+    return OdResult::BAD_ALLOCATION;
+  new(jobs) ConcurrentPoolAllocator(sizeof(Job), worker_count * jobs_per_worker, context, worker_count);
+  instance.jobs_ = jobs;
+  // workers
+  instance.workers_ = reinterpret_cast<Worker *>(
+      mem::allocateBlock(sizeof(Worker) * worker_count, context, alignof(Worker)));
+  if (!jobs->capacity() || !instance.workers_) {
+    release();
+    return OdResult::BAD_ALLOCATION;
+  }
+  for (u32 i = 0; i < worker_count; ++i) {
+    byte *scratch_buffer = nullptr;
+    if (scratch_size_in_bytes) {
+      scratch_buffer = reinterpret_cast<byte *>(mem::allocateBlock(scratch_size_in_bytes, context));
+      if (!scratch_buffer) {
+        release();
+        return OdResult::BAD_ALLOCATION;
+      }
+    }
+    auto *worker = new(instance.workers_ + i) Worker(jobs_per_worker, scratch_size_in_bytes,
+                                                     scratch_buffer, context);
+    worker->scratch_buffer = scratch_buffer;
+    worker->seed = 2654435761u * (i + 1);
+    instance.worker_count_ = i + 1;
+    if (!worker->deque.capacity()) {
+      release();
+      return OdResult::BAD_ALLOCATION;
+    }
+  }
+  // threads
+  mem::setThreadIndex(0);
+#ifdef __linux__
+  if (pin_workers) {
+    caller_pinned = !pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &caller_affinity);
+    pinThread(pthread_self(), 0);
+  }
+#else
+  (void) pin_workers;
+#endif
+  instance.running_.store(true);
+  instance.threads_.reserve(worker_count - 1);
+  for (u32 i = 1; i < worker_count; ++i) {
+    instance.threads_.emplace_back(workerLoop, i);
+#ifdef __linux__
+    if (pin_workers)
+      pinThread(instance.threads_.back().native_handle(), i);
+#endif
+  }
+  return OdResult::SUCCESS;
+}
+
+void JobSystem::release() {
+  auto &instance = get();
+  {
+    std::lock_guard<std::mutex> lock(instance.sleep_mutex_);
+    instance.running_.store(false);
+  }
+  instance.wake_.notify_all();
+  for (auto &thread : instance.threads_)
+    thread.join();
+  instance.threads_.clear();
+#ifdef __linux__
+  if (caller_pinned) {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &caller_affinity);
+    caller_pinned = false;
+  }
+#endif
+  for (u32 i = 0; i < instance.worker_count_; ++i) {
+    ASSERT(instance.workers_[i].deque.empty())
+    byte *scratch_buffer = instance.workers_[i].scratch_buffer;
+    instance.workers_[i].~Worker();
+    mem::freeBlock(scratch_buffer);
+  }
+  mem::freeBlock(instance.workers_);
+  instance.workers_ = nullptr;
+  instance.worker_count_ = 0;
+  if (instance.jobs_) {
+    instance.jobs_->~ConcurrentPoolAllocator();
+    mem::freeBlock(instance.jobs_);
+    instance.jobs_ = nullptr;
+  }
+}
+
+u32 JobSystem::workerCount() {
+  return get().worker_count_;
+}
+
+StackAllocator &JobSystem::scratch(u32 worker_index) {
+  auto &instance = get();
+  ASSERT(worker_index < instance.worker_count_)
+  return instance.workers_[worker_index].scratch;
+}
+
+Job *JobSystem::allocateJob(Job *parent) {
+  auto &instance = get();
+  ASSERT(mem::threadIndex() < instance.worker_count_)
+  auto *job = reinterpret_cast<Job *>(instance.jobs_->allocateCached(mem::threadIndex()));
+  if (!job)
+    return nullptr;
+  new(job) Job;
+  job->parent = parent;
+  job->unfinished.store(1, std::memory_order_relaxed);
+  // the parent is unfinished, so it can't reach zero before this increment
+  if (parent)
+    parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+  return job;
+}
+
+void JobSystem::run(Job *job) {
+  auto &instance = get();
+  const u32 worker_index = mem::threadIndex();
+  ASSERT(worker_index < instance.worker_count_)
+  if (!instance.workers_[worker_index].deque.push(job)) {
+    instance.execute(job, worker_index);
+    return;
+  }
+  // pairs with the fence of a worker going to sleep: either it sees the
+  // job or we see it sleeping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (instance.sleeping_.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(instance.sleep_mutex_);
+    instance.wake_.notify_one();
+  }
+}
+
+void JobSystem::wait(Job *job) {
+  auto &instance = get();
+  const u32 worker_index = mem::threadIndex();
+  ASSERT(worker_index < instance.worker_count_)
+  ASSERT(!job->parent)
+  while (job->unfinished.load(std::memory_order_acquire)) {
+    if (Job *next = instance.findJob(worker_index))
+      instance.execute(next, worker_index);
+    else
+      std::this_thread::yield();
+  }
+  instance.jobs_->freeObjectCached(job, worker_index);
+}
+
+bool JobSystem::isFinished(const Job *job) {
+  return job->unfinished.load(std::memory_order_acquire) == 0;
+}
+
+u32 JobSystem::grainSize(u32 count) {
+  return std::max(1u, count / (std::max(1u, get().worker_count_) * 8));
+}
+
+Job *JobSystem::findJob(u32 worker_index) {
+  auto &worker = workers_[worker_index];
+  Job *job = nullptr;
+  if (worker.deque.pop(job))
+    return job;
+  if (worker_count_ < 2)
+    return nullptr;
+  // start from a random victim so thieves spread over the workers
+  worker.seed ^= worker.seed << 13u;
+  worker.seed ^= worker.seed >> 17u;
+  worker.seed ^= worker.seed << 5u;
+  const u32 first = worker.seed % worker_count_;
+  for (u32 i = 0; i < worker_count_; ++i) {
+    const u32 victim = (first + i) % worker_count_;
+    if (victim != worker_index && workers_[victim].deque.steal(job))
+      return job;
+  }
+  return nullptr;
+}
+
+void JobSystem::execute(Job *job, u32 worker_index) {
+  auto &worker = workers_[worker_index];
+  ++worker.depth;
+  job->function(job);
+  finish(job, worker_index);
+  if (!--worker.depth)
+    worker.scratch.clear();
+}
+
+void JobSystem::finish(Job *job, u32 worker_index) {
+  while (job) {
+    // a finished job without parent may be freed by its waiter right away
+    Job *parent = job->parent;
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      return;
+    if (!parent)
+      return;
+    jobs_->freeObjectCached(job, worker_index);
+    job = parent;
+  }
+}
+
+bool JobSystem::hasQueuedJobs() const {
+  for (u32 i = 0; i < worker_count_; ++i)
+    if (!workers_[i].deque.empty())
+      return true;
+  return false;
+}
+
+void JobSystem::workerLoop(u32 worker_index) {
+  mem::setThreadIndex(worker_index);
+  auto &instance = get();
+  u32 idle_count = 0;
+  while (instance.running_.load(std::memory_order_acquire)) {
+    if (Job *job = instance.findJob(worker_index)) {
+      instance.execute(job, worker_index);
+      idle_count = 0;
+      continue;
+    }
+    if (++idle_count < idle_spin_count) {
+      std::this_thread::yield();
+      continue;
+    }
+    idle_count = 0;
+    std::unique_lock<std::mutex> lock(instance.sleep_mutex_);
+    instance.sleeping_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (instance.running_.load() && !instance.hasQueuedJobs())
+      instance.wake_.wait(lock);
+    instance.sleeping_.fetch_sub(1);
+  }
+  instance.jobs_->flushCache(worker_index);
+}
+
+}
@@ -0,0 +1,252 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file job_system.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_JOBS_JOB_SYSTEM_H
+#define ODYSSEUS_ODYSSEUS_JOBS_JOB_SYSTEM_H
+
+#include <odysseus/containers/object_pool.h>
+#include <odysseus/containers/work_stealing_deque.h>
+#include <odysseus/memory/concurrent_pool_allocator.h>
+#include <odysseus/memory/stack_allocator.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace odysseus {
+
+/// Job record
+/// A job runs a callable stored in its own payload. Jobs form a tree:
+/// a job is unfinished until itself and all of its children are finished.
+struct Job {
+  /// size of the callable storage
+  static constexpr u32 payload_size = 96;
+
+  /// runs (and destroys) the callable stored in data
+  void (*function)(Job *){nullptr};
+  /// job notified when this one finishes
+  Job *parent{nullptr};
+  /// 1 (the job itself) + number of unfinished children
+  std::atomic<u32> unfinished{0};
+  alignas(16) byte data[payload_size];
+};
+
+/// Work-Stealing Job System Singleton
+/// Runs jobs on a fixed set of worker threads. Each worker owns a
+/// WorkStealingDeque: jobs are pushed to and popped from the deque of the
+/// worker that created them, and idle workers steal from the others. The
+/// thread calling init is worker 0, it runs jobs while it waits for them.
+///
+/// \note Job records come from a ConcurrentPoolAllocator with one thread
+/// cache per worker, so creating and freeing jobs is usually a few loads
+/// and stores on worker-owned memory.
+/// \note Workers are identified by mem::threadIndex() (init sets it for
+/// every worker), so worker i may also use mem::frameArena(i).
+/// \note Each worker owns a StackAllocator scratch arena. Jobs may allocate
+/// temporaries from scratch() of the worker running them, the arena is
+/// cleared every time the worker finishes its outermost job. Scratch memory
+/// must not outlive the job that allocated it.
+/// \note Job lifetime: jobs created with a parent are freed as soon as they
+/// finish. Jobs without parent must be waited exactly once, wait frees
+/// them.
+/// \note Idle workers spin for a while and then sleep until new jobs are
+/// pushed.
+class JobSystem {
+public:
+  /****************************************************************************
+                                 INITIALIZATION
+  ****************************************************************************/
+  /// Starts worker_count - 1 threads (the calling thread is worker 0)
+  /// \param worker_count number of workers (0 uses every hardware thread)
+  /// \param scratch_size_in_bytes capacity of each worker scratch arena
+  /// \param jobs_per_worker job records per worker (also the deque capacity)
+  /// \param pin_workers pins worker i to cpu i, including the calling
+  /// thread (worker 0) until release, linux only
+  /// \param context memory context job records, deques and arenas come from
+  /// \return BAD_ALLOCATION if memory could not be allocated
+  static OdResult init(u32 worker_count = 0, std::size_t scratch_size_in_bytes = 64 * 1024,
+                       u32 jobs_per_worker = 1024, bool pin_workers = false,
+                       mem::ContextType context = mem::ContextType::GENERAL_PURPOSE);
+  /// Stops and joins all worker threads, frees all memory
+  /// \note No job may be running or pending.
+  static void release();
+  /// \return number of workers (including the thread that called init)
+  static u32 workerCount();
+  /// \param worker_index
+  /// \return scratch arena of the worker
+  static StackAllocator &scratch(u32 worker_index = mem::threadIndex());
+  /****************************************************************************
+                                     JOBS
+  ****************************************************************************/
+  /// Creates a job that calls f()
+  /// \note The job must be created while its parent is unfinished.
+  /// \tparam F callable of up to Job::payload_size bytes
+  /// \param f
+  /// \param parent
+  /// \return the job, nullptr if there are no free job records
+  template<typename F>
+  static Job *create(F &&f, Job *parent = nullptr) {
+    using Callable = std::decay_t<F>;
+    static_assert(sizeof(Callable) <= Job::payload_size && alignof(Callable) <= 16,
+                  "job callable doesn't fit the job payload");
+    Job *job = allocateJob(parent);
+    if (!job)
+      return nullptr;
+    new(job->data) Callable(std::forward<F>(f));
+    job->function = [](Job *j) {
+      auto *callable = reinterpret_cast<Callable *>(j->data);
+      (*callable)();
+      callable->~Callable();
+    };
+    return job;
+  }
+  /// Queues the job in the deque of the calling worker. The job runs
+  /// immediately (on the calling thread) if the deque is full.
+  /// \param job
+  static void run(Job *job);
+  /// Runs other jobs until the job (and all its children) is finished, then
+  /// frees it.
+  /// \note Only jobs without parent can be waited.
+  /// \param job
+  static void wait(Job *job);
+  /// \param job
+  /// \return true if the job and all its children are finished
+  static bool isFinished(const Job *job);
+  /****************************************************************************
+                                 PARALLEL FOR
+  ****************************************************************************/
+  /// Calls f(i) for every i in [begin, end) across all workers and waits.
+  /// The range is split in halves recursively, so idle workers steal large
+  /// chunks first, until chunks have at most grain iterations.
+  /// \tparam F
+  /// \param begin
+  /// \param end
+  /// \param f callable as f(u32)
+  /// \param grain maximum iterations per job (0 picks one from the range
+  /// size and the number of workers)
+  template<typename F>
+  static void parallelFor(u32 begin, u32 end, const F &f, u32 grain = 0) {
+    if (begin >= end)
+      return;
+    if (!grain)
+      grain = grainSize(end - begin);
+    Job *root = create([]() {});
+    if (!root) {
+      for (u32 i = begin; i < end; ++i)
+        f(i);
+      return;
+    }
+    splitRange(root, begin, end, grain, &f);
+    run(root);
+    wait(root);
+  }
+  /// Calls f(object) for every live object of the pool across all workers
+  /// and waits.
+  /// \note Objects must not be created or destroyed while iterating.
+  /// \tparam O
+  /// \tparam F
+  /// \param pool
+  /// \param f callable as f(O&)
+  /// \param grain maximum objects per job (0 picks one automatically)
+  template<typename O, typename F>
+  static void parallelFor(ObjectPool<O> &pool, const F &f, u32 grain = 0) {
+    O *objects = pool.data();
+    parallelFor(0, pool.size(), [objects, &f](u32 i) { f(objects[i]); }, grain);
+  }
+  /// \param count number of iterations
+  /// \return grain size used by parallelFor, about 8 jobs per worker
+  static u32 grainSize(u32 count);
+
+  JobSystem &operator=(const JobSystem &) = delete;
+
+private:
+  struct alignas(64) Worker {
+    Worker(u32 deque_capacity, std::size_t scratch_size, byte *scratch_buffer,
+           mem::ContextType context)
+        : deque(deque_capacity, context), scratch(scratch_size, scratch_buffer) {}
+    WorkStealingDeque<Job *> deque;
+    StackAllocator scratch;
+    byte *scratch_buffer{nullptr};
+    /// nesting level of running jobs
+    u32 depth{0};
+    /// victim selection state
+    u32 seed{0};
+  };
+
+  JobSystem() = default;
+  static inline JobSystem &get() {
+    static JobSystem singleton;
+    return singleton;
+  }
+  /// \param parent
+  /// \return job record with no function, nullptr if the pool is empty
+  static Job *allocateJob(Job *parent);
+  /// Queues jobs for the upper halves of [begin, end) and runs the rest
+  /// inline, all jobs are children of parent.
+  template<typename F>
+  static void splitRange(Job *parent, u32 begin, u32 end, u32 grain, const F *f) {
+    while (end - begin > grain) {
+      const u32 middle = begin + (end - begin) / 2;
+      Job *job = create([parent, middle, end, grain, f]() {
+        splitRange(parent, middle, end, grain, f);
+      }, parent);
+      if (!job)
+        break;
+      run(job);
+      end = middle;
+    }
+    for (u32 i = begin; i < end; ++i)
+      (*f)(i);
+  }
+  /// \param worker_index
+  /// \return a job from the worker deque or stolen from another worker
+  Job *findJob(u32 worker_index);
+  /// Runs the job and finishes it
+  void execute(Job *job, u32 worker_index);
+  /// Decrements the unfinished counter of the job, propagating to its
+  /// parent once it reaches zero
+  void finish(Job *job, u32 worker_index);
+  /// \return true if any worker deque has jobs
+  [[nodiscard]] bool hasQueuedJobs() const;
+  /// Worker thread entry point
+  static void workerLoop(u32 worker_index);
+
+  ConcurrentPoolAllocator *jobs_{nullptr};
+  Worker *workers_{nullptr};
+  u32 worker_count_{0};
+  std::vector<std::thread> threads_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  alignas(64) std::atomic<u32> sleeping_{0};
+  std::atomic<bool> running_{false};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_JOBS_JOB_SYSTEM_H
@@ -0,0 +1,287 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file task_graph.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/jobs/task_graph.h>
+#include <odysseus/jobs/job_system.h>
+#include <odysseus/debug/profiler.h>
+#include <algorithm>
+
+namespace odysseus {
+
+TaskGraph::TaskGraph(u32 max_task_count, mem::ContextType context) : context_{context} {
+  if (!max_task_count)
+    return;
+  tasks_ = reinterpret_cast<Task *>(
+      mem::allocateBlock(sizeof(Task) * max_task_count, context, alignof(Task)));
+  schedule_ = reinterpret_cast<u32 *>(mem::allocateBlock(sizeof(u32) * max_task_count, context));
+  if (!tasks_ || !schedule_) {
+    mem::freeBlock(tasks_);
+    mem::freeBlock(schedule_);
+    tasks_ = nullptr;
+    schedule_ = nullptr;
+    return;
+  }
+  // free slots form a linked list
+  for (u32 i = 0; i < max_task_count; ++i) {
+    new(tasks_ + i) Task();
+    tasks_[i].next_free = i + 1;
+  }
+  capacity_ = max_task_count;
+}
+
+TaskGraph::~TaskGraph() {
+  clear();
+  for (u32 i = 0; i < capacity_; ++i)
+    tasks_[i].~Task();
+  mem::freeBlock(tasks_);
+  mem::freeBlock(schedule_);
+  mem::freeBlock(successors_);
+}
+
+TaskGraph::TaskId TaskGraph::allocateTask(const char *name, std::initializer_list<u32> reads,
+                                          std::initializer_list<u32> writes) {
+  if (free_head_ >= capacity_)
+    return {};
+  u64 read_mask = 0;
+  u64 write_mask = 0;
+  for (u32 resource : reads) {
+    if (resource >= max_resource_count)
+      return {};
+    read_mask |= 1ull << resource;
+  }
+  for (u32 resource : writes) {
+    if (resource >= max_resource_count)
+      return {};
+    write_mask |= 1ull << resource;
+  }
+  const u32 index = free_head_;
+  auto &task = tasks_[index];
+  free_head_ = task.next_free;
+  task.name = name;
+  task.reads = read_mask;
+  task.writes = write_mask;
+  task.sequence = sequence_++;
+  task.generation = (task.generation + 1) | 1u;
+  ++task_count_;
+  dirty_ = true;
+  return {index, task.generation};
+}
+
+OdResult TaskGraph::removeTask(TaskId id) {
+  if (!isAlive(id))
+    return OdResult::INVALID_INPUT;
+  auto &task = tasks_[id.index];
+  task.destroy(task.data);
+  task.function = nullptr;
+  task.destroy = nullptr;
+  task.generation++;
+  task.next_free = free_head_;
+  free_head_ = id.index;
+  --task_count_;
+  dirty_ = true;
+  return OdResult::SUCCESS;
+}
+
+void TaskGraph::clear() {
+  for (u32 i = 0; i < capacity_; ++i)
+    if (tasks_[i].generation & 1u)
+      removeTask({i, tasks_[i].generation});
+}
+
+bool TaskGraph::isAlive(TaskId id) const {
+  return id.index < capacity_ && (id.generation & 1u) && tasks_[id.index].generation == id.generation;
+}
+
+u32 TaskGraph::taskCount() const {
+  return task_count_;
+}
+
+u32 TaskGraph::capacity() const {
+  return capacity_;
+}
+
+template<typename F>
+void TaskGraph::forEachDependency(u32 count, const F &f) {
+  for (u32 i = 0; i < count; ++i)
+    tasks_[schedule_[i]].mark = 0;
+  for (u32 i = 0; i < count; ++i) {
+    const auto &task = tasks_[schedule_[i]];
+    for (u64 resources = task.reads | task.writes; resources; resources &= resources - 1) {
+      const u64 resource = resources & (~resources + 1);
+      // walk back to the last writer of the resource, a writer also waits
+      // for the readers in between
+      for (u32 j = i; j-- > 0;) {
+        auto &previous = tasks_[schedule_[j]];
+        const bool is_writer = previous.writes & resource;
+        if (is_writer || ((task.writes & resource) && (previous.reads & resource))) {
+          // link each pair once, even if they share many resources
+          if (previous.mark != i + 1) {
+            previous.mark = i + 1;
+            f(schedule_[j], schedule_[i]);
+          }
+        }
+        if (is_writer)
+          break;
+      }
+    }
+  }
+}
+
+OdResult TaskGraph::compile() {
+  // tasks in declaration order
+  u32 count = 0;
+  for (u32 i = 0; i < capacity_; ++i)
+    if (tasks_[i].generation & 1u) {
+      schedule_[count++] = i;
+      tasks_[i].dependency_count = 0;
+      tasks_[i].successor_count = 0;
+      tasks_[i].level = 0;
+    }
+  std::sort(schedule_, schedule_ + count, [&](u32 a, u32 b) {
+    return tasks_[a].sequence < tasks_[b].sequence;
+  });
+  // count dependencies, predecessors come first so their levels are final
+  u32 dependency_count = 0;
+  forEachDependency(count, [&](u32 from, u32 to) {
+    tasks_[from].successor_count++;
+    tasks_[to].dependency_count++;
+    tasks_[to].level = std::max(tasks_[to].level, tasks_[from].level + 1);
+    ++dependency_count;
+  });
+  if (dependency_count > successors_capacity_) {
+    mem::freeBlock(successors_);
+    successors_capacity_ = 0;
+    successors_ = reinterpret_cast<u32 *>(mem::allocateBlock(sizeof(u32) * dependency_count, context_));
+    if (!successors_)
+      return OdResult::BAD_ALLOCATION;
+    successors_capacity_ = dependency_count;
+  }
+  // successor lists
+  u32 offset = 0;
+  for (u32 i = 0; i < count; ++i) {
+    auto &task = tasks_[schedule_[i]];
+    task.first_successor = offset;
+    offset += task.successor_count;
+    task.successor_count = 0;
+  }
+  forEachDependency(count, [&](u32 from, u32 to) {
+    auto &task = tasks_[from];
+    successors_[task.first_successor + task.successor_count++] = to;
+  });
+  // group tasks by level, which keeps the order topological
+  std::sort(schedule_, schedule_ + count, [&](u32 a, u32 b) {
+    if (tasks_[a].level != tasks_[b].level)
+      return tasks_[a].level < tasks_[b].level;
+    return tasks_[a].sequence < tasks_[b].sequence;
+  });
+  root_count_ = 0;
+  while (root_count_ < count && !tasks_[schedule_[root_count_]].level)
+    ++root_count_;
+  level_count_ = count ? tasks_[schedule_[count - 1]].level + 1 : 0;
+  scheduled_count_ = count;
+  dirty_ = false;
+  ++compile_count_;
+  return OdResult::SUCCESS;
+}
+
+bool TaskGraph::needsCompile() const {
+  return dirty_;
+}
+
+u32 TaskGraph::compileCount() const {
+  return compile_count_;
+}
+
+TaskGraph::TaskId TaskGraph::scheduledTask(u32 i) const {
+  if (dirty_ || i >= scheduled_count_)
+    return {};
+  return {schedule_[i], tasks_[schedule_[i]].generation};
+}
+
+u32 TaskGraph::dependencyCount(TaskId id) const {
+  return isAlive(id) ? tasks_[id.index].dependency_count : 0;
+}
+
+u32 TaskGraph::level(TaskId id) const {
+  return isAlive(id) ? tasks_[id.index].level : 0;
+}
+
+u32 TaskGraph::levelCount() const {
+  return level_count_;
+}
+
+OdResult TaskGraph::run() {
+  if (dirty_) {
+    auto result = compile();
+    if (result != OdResult::SUCCESS)
+      return result;
+  }
+  for (u32 i = 0; i < scheduled_count_; ++i) {
+    auto &task = tasks_[schedule_[i]];
+    task.remaining.store(task.dependency_count, std::memory_order_relaxed);
+  }
+  Job *root = JobSystem::workerCount() ? JobSystem::create([]() {}) : nullptr;
+  if (!root) {
+    // the schedule order is topological
+    for (u32 i = 0; i < scheduled_count_; ++i) {
+      auto &task = tasks_[schedule_[i]];
+      ODYSSEUS_PROFILE_ZONE(task.name);
+      task.function(task.data);
+    }
+    return OdResult::SUCCESS;
+  }
+  for (u32 i = 0; i < root_count_; ++i)
+    launch(schedule_[i], root);
+  JobSystem::run(root);
+  JobSystem::wait(root);
+  return OdResult::SUCCESS;
+}
+
+void TaskGraph::launch(u32 task_index, Job *root) {
+  Job *job = JobSystem::create([this, task_index, root]() { execute(task_index, root); }, root);
+  if (!job) {
+    execute(task_index, root);
+    return;
+  }
+  JobSystem::run(job);
+}
+
+void TaskGraph::execute(u32 task_index, Job *root) {
+  auto &task = tasks_[task_index];
+  {
+    ODYSSEUS_PROFILE_ZONE(task.name);
+    task.function(task.data);
+  }
+  for (u32 i = 0; i < task.successor_count; ++i) {
+    const u32 successor = successors_[task.first_successor + i];
+    // acq_rel: the successor sees the writes of all its dependencies
+    if (tasks_[successor].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      launch(successor, root);
+  }
+}
+
+}
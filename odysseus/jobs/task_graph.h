@@ -0,0 +1,216 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file task_graph.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_JOBS_TASK_GRAPH_H
+#define ODYSSEUS_ODYSSEUS_JOBS_TASK_GRAPH_H
+
+#include <odysseus/memory/mem.h>
+#include <atomic>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace odysseus {
+
+struct Job;
+
+/// RAII Frame Task Graph
+/// Declarative set of per-frame tasks (systems). Each task declares the
+/// resources it reads and writes, and the graph derives the dependencies
+/// between tasks from them: a task runs after the last task declared
+/// before it that writes one of its resources, and a task that writes a
+/// resource also runs after the tasks reading it since that write. Tasks
+/// that share no written resource (animation, AI, audio...) run in
+/// parallel on the JobSystem workers.
+///
+/// \note Schedule: compile turns the graph into a topologically ordered
+/// task list with a successor list and a dependency count per task.
+/// Running a frame resets the counters, launches the tasks without
+/// dependencies and lets every finished task launch the successors whose
+/// counter reaches zero. Frames don't allocate memory (job records come from
+/// the JobSystem pool). Adding or removing tasks marks the schedule dirty
+/// and run compiles it again before the next frame.
+/// \note Task records and the schedule live in the memory context given
+/// at construction.
+/// \note Resources are identified by indices below max_resource_count
+/// (component types, buffers...). Tasks that must run in a given order
+/// without sharing data can declare a common resource.
+/// \note Frames run on the JobSystem and must be started by a worker
+/// (usually worker 0). Without a JobSystem, tasks run on the calling
+/// thread in schedule order.
+class TaskGraph {
+public:
+  /// Task reference
+  struct TaskId {
+    u32 index{0};
+    /// slot generation at creation time, zero identifies an invalid id
+    u32 generation{0};
+    [[nodiscard]] inline bool isValid() const { return generation != 0; }
+  };
+  /// number of distinct resources tasks can declare
+  static constexpr u32 max_resource_count = 64;
+  /// size of the callable storage of each task
+  static constexpr u32 payload_size = 64;
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  TaskGraph() = default;
+  /// \param max_task_count
+  /// \param context memory context task records and the schedule come from
+  explicit TaskGraph(u32 max_task_count,
+                     mem::ContextType context = mem::ContextType::GENERAL_PURPOSE);
+  ///
+  ~TaskGraph();
+  TaskGraph(const TaskGraph &) = delete;
+  TaskGraph &operator=(const TaskGraph &) = delete;
+  /****************************************************************************
+                                    TASKS
+  ****************************************************************************/
+  /// Adds a task that calls f() every frame
+  /// \tparam F callable of up to payload_size bytes
+  /// \param name task name, must outlive the graph (usually a string literal)
+  /// \param reads indices of the resources the task reads
+  /// \param writes indices of the resources the task writes
+  /// \param f
+  /// \return task id, invalid if the graph is full or a resource index is
+  /// out of range
+  template<typename F>
+  TaskId addTask(const char *name, std::initializer_list<u32> reads,
+                 std::initializer_list<u32> writes, F &&f) {
+    using Callable = std::decay_t<F>;
+    static_assert(sizeof(Callable) <= payload_size && alignof(Callable) <= 16,
+                  "task callable doesn't fit the task payload");
+    auto id = allocateTask(name, reads, writes);
+    if (!id.isValid())
+      return id;
+    auto &task = tasks_[id.index];
+    new(task.data) Callable(std::forward<F>(f));
+    task.function = [](void *data) { (*reinterpret_cast<Callable *>(data))(); };
+    task.destroy = [](void *data) { reinterpret_cast<Callable *>(data)->~Callable(); };
+    return id;
+  }
+  /// \param id
+  /// \return INVALID_INPUT if the task doesn't exist
+  OdResult removeTask(TaskId id);
+  /// Removes all tasks
+  void clear();
+  /// \param id
+  /// \return true if the task exists
+  [[nodiscard]] bool isAlive(TaskId id) const;
+  /// \return number of tasks
+  [[nodiscard]] u32 taskCount() const;
+  /// \return maximum number of tasks
+  [[nodiscard]] u32 capacity() const;
+  /****************************************************************************
+                                   SCHEDULE
+  ****************************************************************************/
+  /// Derives the task dependencies and builds the schedule
+  /// \return BAD_ALLOCATION if the schedule could not be allocated
+  OdResult compile();
+  /// \return true if tasks changed since the last compile
+  [[nodiscard]] bool needsCompile() const;
+  /// \return number of times the schedule was built
+  [[nodiscard]] u32 compileCount() const;
+  /// \param i position in the schedule
+  /// \return i-th task of the schedule, tasks are sorted by level
+  [[nodiscard]] TaskId scheduledTask(u32 i) const;
+  /// \param id
+  /// \return number of tasks the task waits for
+  [[nodiscard]] u32 dependencyCount(TaskId id) const;
+  /// \param id
+  /// \return length of the longest dependency chain that ends at the task
+  /// (tasks without dependencies have level 0)
+  [[nodiscard]] u32 level(TaskId id) const;
+  /// \return number of levels, the minimum number of sequential steps a
+  /// frame takes
+  [[nodiscard]] u32 levelCount() const;
+  /****************************************************************************
+                                    FRAME
+  ****************************************************************************/
+  /// Runs every task once (compiling the schedule first if needed) and
+  /// waits for all of them.
+  /// \return BAD_ALLOCATION if the schedule could not be compiled
+  OdResult run();
+
+private:
+  struct Task {
+    const char *name{nullptr};
+    void (*function)(void *){nullptr};
+    void (*destroy)(void *){nullptr};
+    u64 reads{0};
+    u64 writes{0};
+    /// declaration order
+    u64 sequence{0};
+    /// odd while the task exists
+    u32 generation{0};
+    u32 next_free{0};
+    // schedule
+    u32 dependency_count{0};
+    u32 first_successor{0};
+    u32 successor_count{0};
+    u32 level{0};
+    /// last schedule position that linked to this task (compile only)
+    u32 mark{0};
+    /// dependencies not finished in the current frame
+    std::atomic<u32> remaining{0};
+    alignas(16) byte data[payload_size];
+  };
+  /// \param name
+  /// \param reads
+  /// \param writes
+  /// \return id of a new task with no callable
+  TaskId allocateTask(const char *name, std::initializer_list<u32> reads,
+                      std::initializer_list<u32> writes);
+  /// Calls f(from, to) once for each dependency, in schedule order
+  template<typename F>
+  void forEachDependency(u32 count, const F &f);
+  /// Queues the task on the job system (or runs it inline if no job record
+  /// is available)
+  void launch(u32 task_index, Job *root);
+  /// Runs the task and launches the successors it unblocks
+  void execute(u32 task_index, Job *root);
+
+  Task *tasks_{nullptr};
+  u32 capacity_{0};
+  u32 task_count_{0};
+  u32 free_head_{0};
+  u64 sequence_{0};
+  /// task indices in schedule order
+  u32 *schedule_{nullptr};
+  u32 scheduled_count_{0};
+  u32 root_count_{0};
+  u32 level_count_{0};
+  u32 *successors_{nullptr};
+  u32 successors_capacity_{0};
+  u32 compile_count_{0};
+  bool dirty_{true};
+  mem::ContextType context_{mem::ContextType::GENERAL_PURPOSE};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_JOBS_TASK_GRAPH_H
@@ -0,0 +1,138 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file allocation_tracking.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_MEMORY_ALLOCATION_TRACKING_H
+#define ODYSSEUS_ODYSSEUS_MEMORY_ALLOCATION_TRACKING_H
+
+#include <ponos/common/defs.h>
+#include <odysseus/debug/debug.h>
+#include <cstddef>
+#include <vector>
+#ifdef ODYSSEUS_DEBUG
+#include <ponos/log/memory_dump.h>
+#endif
+
+namespace odysseus {
+
+/// Allocation tracking policies
+/// Stack allocators notify their tracking policy on every allocation, roll
+/// back and clear. The policy is a template parameter, so the notifications
+/// of empty policies are inlined away and cost nothing.
+///
+/// \note A policy provides:
+/// \note - onAllocate(offset, size_in_bytes) after a block is allocated
+/// \note - onFreeTo(offset) after the stack rolls back to offset
+/// \note - onClear() after all blocks are released
+/// \note - keeps_regions, true if the policy provides regions() for dumps
+
+/// Tracks nothing (release builds)
+struct NoTracking {
+  static constexpr bool keeps_regions = false;
+  inline void onAllocate(std::size_t, std::size_t) {}
+  inline void onFreeTo(std::size_t) {}
+  inline void onClear() {}
+};
+
+/// Keeps allocation statistics
+struct CountTracking {
+  static constexpr bool keeps_regions = false;
+  inline void onAllocate(std::size_t, std::size_t size_in_bytes) {
+    ++allocation_count;
+    allocated_size_in_bytes += size_in_bytes;
+  }
+  inline void onFreeTo(std::size_t) { ++free_count; }
+  inline void onClear() { ++clear_count; }
+
+  /// number of allocated blocks
+  u64 allocation_count{0};
+  /// total size of allocated blocks (alignment shifts included)
+  u64 allocated_size_in_bytes{0};
+  /// number of roll backs
+  u64 free_count{0};
+  /// number of clears
+  u64 clear_count{0};
+};
+
+/// Keeps one memory dump region per live block (debug builds)
+/// \note Roll backs search the block list linearly.
+/// \note Regions are only kept when ODYSSEUS_DEBUG is defined, otherwise only
+/// \note block offsets are tracked.
+struct RegionTracking {
+#ifdef ODYSSEUS_DEBUG
+  static constexpr bool keeps_regions = true;
+#else
+  static constexpr bool keeps_regions = false;
+#endif
+  inline void onAllocate(std::size_t offset, std::size_t size_in_bytes) {
+    handles_.emplace_back(offset);
+#ifdef ODYSSEUS_DEBUG
+    regions_.push_back({
+                           offset,
+                           size_in_bytes,
+                           1,
+                           ponos::ConsoleColors::color(handles_.size()),
+                           {}
+                       });
+#else
+    (void) size_in_bytes;
+#endif
+  }
+  inline void onFreeTo(std::size_t offset) {
+    std::size_t i = 0;
+    for (std::size_t j = 0; j < handles_.size(); ++j)
+      if (handles_[j] == offset)
+        i = j;
+    handles_.resize(i);
+    ODYSSEUS_DEBUG_CODE(regions_.resize(i);)
+  }
+  inline void onClear() {
+    handles_.clear();
+    ODYSSEUS_DEBUG_CODE(regions_.clear();)
+  }
+#ifdef ODYSSEUS_DEBUG
+  /// \return regions of live blocks
+  [[nodiscard]] inline const std::vector<ponos::MemoryDumper::Region> &regions() const {
+    return regions_;
+  }
+#endif
+
+private:
+  std::vector<std::size_t> handles_;
+#ifdef ODYSSEUS_DEBUG
+  std::vector<ponos::MemoryDumper::Region> regions_;
+#endif
+};
+
+#ifdef ODYSSEUS_DEBUG
+using DefaultTracking = RegionTracking;
+#else
+using DefaultTracking = NoTracking;
+#endif
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_MEMORY_ALLOCATION_TRACKING_H
@@ -0,0 +1,215 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file concurrent_pool_allocator.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/memory/concurrent_pool_allocator.h>
+#include <algorithm>
+
+namespace odysseus {
+
+#define CPA_HEAD_INDEX(HEAD) \
+  static_cast<u32>((HEAD) & 0xffffffffu)
+
+#define CPA_BUILD_HEAD(INDEX, TAG) \
+  ((static_cast<u64>(TAG) << 32u) | (INDEX))
+
+ConcurrentPoolAllocator::ConcurrentPoolAllocator(u32 object_size_in_bytes, u32 object_count,
+                                                 mem::ContextType context, u32 thread_count)
+    : capacity_{object_count},
+      object_size_in_bytes_{static_cast<u32>(mem::alignTo(object_size_in_bytes, sizeof(u32)))} {
+  static_assert(sizeof(std::atomic<u32>) == sizeof(u32));
+  if (!object_count || !object_size_in_bytes)
+    return;
+  data_ = reinterpret_cast<byte *>(
+      mem::allocateBlock(static_cast<std::size_t>(object_size_in_bytes_) * object_count, context));
+  if (!data_) {
+    capacity_ = 0;
+    return;
+  }
+  // create linked list for free objects
+  for (u32 i = 0; i < object_count; i++)
+    new(link(i)) std::atomic<u32>(i + 1);
+  head_.store(CPA_BUILD_HEAD(0, 0));
+  if (thread_count) {
+    magazines_ = reinterpret_cast<Magazine *>(
+        mem::allocateBlock(sizeof(Magazine) * thread_count, context, alignof(Magazine)));
+    if (!magazines_) {
+      mem::freeBlock(data_);
+      data_ = nullptr;
+      capacity_ = 0;
+      return;
+    }
+    for (u32 i = 0; i < thread_count; ++i)
+      new(magazines_ + i) Magazine();
+    thread_count_ = thread_count;
+  }
+}
+
+ConcurrentPoolAllocator::~ConcurrentPoolAllocator() {
+  mem::freeBlock(magazines_);
+  mem::freeBlock(data_);
+}
+
+u32 ConcurrentPoolAllocator::capacityInBytes() const {
+  return capacity_ * object_size_in_bytes_;
+}
+
+u32 ConcurrentPoolAllocator::capacity() const {
+  return capacity_;
+}
+
+u32 ConcurrentPoolAllocator::size() const {
+  // objects in caches left the shared list but are still free
+  u32 cached = 0;
+  for (u32 i = 0; i < thread_count_; ++i)
+    cached += magazines_[i].count.load(std::memory_order_relaxed);
+  // a concurrent flush lowers size before the magazine count, don't wrap
+  const u32 size = size_.load(std::memory_order_relaxed);
+  return size > cached ? size - cached : 0;
+}
+
+u32 ConcurrentPoolAllocator::objectSizeInBytes() const {
+  return object_size_in_bytes_;
+}
+
+u32 ConcurrentPoolAllocator::threadCount() const {
+  return thread_count_;
+}
+
+void *ConcurrentPoolAllocator::allocate() {
+  u64 head = head_.load(std::memory_order_acquire);
+  u32 index;
+  do {
+    index = CPA_HEAD_INDEX(head);
+    if (index >= capacity_)
+      return nullptr;
+    // the object may be taken by another thread before we read its link,
+    // in that case the tag has changed and the exchange below fails
+    const u32 next = link(index)->load(std::memory_order_relaxed);
+    if (head_.compare_exchange_weak(head, CPA_BUILD_HEAD(next, (head >> 32u) + 1),
+                                    std::memory_order_acquire,
+                                    std::memory_order_acquire))
+      break;
+  } while (true);
+  size_.fetch_add(1, std::memory_order_relaxed);
+  return data_ + static_cast<std::size_t>(index) * object_size_in_bytes_;
+}
+
+void ConcurrentPoolAllocator::freeObject(void *ptr) {
+  ASSERT(ptr >= data_ && ptr < data_ + capacityInBytes())
+  const auto index = static_cast<u32>((reinterpret_cast<byte *>(ptr) - data_) / object_size_in_bytes_);
+  u64 head = head_.load(std::memory_order_relaxed);
+  do {
+    link(index)->store(CPA_HEAD_INDEX(head), std::memory_order_relaxed);
+  } while (!head_.compare_exchange_weak(head, CPA_BUILD_HEAD(index, (head >> 32u) + 1),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+  size_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void *ConcurrentPoolAllocator::allocateCached(u32 thread_index) {
+  ASSERT(thread_index < thread_count_)
+  auto &magazine = magazines_[thread_index];
+  // only the owner thread writes count, relaxed accesses are enough
+  u32 count = magazine.count.load(std::memory_order_relaxed);
+  if (!count) {
+    count = popChain(magazine_batch_size, magazine.objects);
+    if (!count)
+      return nullptr;
+  }
+  --count;
+  magazine.count.store(count, std::memory_order_relaxed);
+  return data_ + static_cast<std::size_t>(magazine.objects[count]) * object_size_in_bytes_;
+}
+
+void ConcurrentPoolAllocator::freeObjectCached(void *ptr, u32 thread_index) {
+  ASSERT(thread_index < thread_count_)
+  ASSERT(ptr >= data_ && ptr < data_ + capacityInBytes())
+  auto &magazine = magazines_[thread_index];
+  u32 count = magazine.count.load(std::memory_order_relaxed);
+  if (count == magazine_size) {
+    // the oldest objects go back, the most recently used stay
+    pushChain(magazine_batch_size, magazine.objects);
+    count -= magazine_batch_size;
+    std::copy(magazine.objects + magazine_batch_size, magazine.objects + magazine_size,
+              magazine.objects);
+  }
+  magazine.objects[count] = static_cast<u32>((reinterpret_cast<byte *>(ptr) - data_) / object_size_in_bytes_);
+  magazine.count.store(count + 1, std::memory_order_relaxed);
+}
+
+void ConcurrentPoolAllocator::flushCache(u32 thread_index) {
+  ASSERT(thread_index < thread_count_)
+  auto &magazine = magazines_[thread_index];
+  const u32 count = magazine.count.load(std::memory_order_relaxed);
+  if (count)
+    pushChain(count, magazine.objects);
+  magazine.count.store(0, std::memory_order_relaxed);
+}
+
+u32 ConcurrentPoolAllocator::popChain(u32 count, u32 *objects) {
+  u64 head = head_.load(std::memory_order_acquire);
+  u32 popped;
+  do {
+    // walk the chain, the walk is discarded if the head changes meanwhile
+    u32 index = CPA_HEAD_INDEX(head);
+    for (popped = 0; popped < count && index < capacity_; ++popped) {
+      objects[popped] = index;
+      index = link(index)->load(std::memory_order_relaxed);
+    }
+    if (!popped)
+      return 0;
+    if (head_.compare_exchange_weak(head, CPA_BUILD_HEAD(index, (head >> 32u) + 1),
+                                    std::memory_order_acquire,
+                                    std::memory_order_acquire))
+      break;
+  } while (true);
+  size_.fetch_add(popped, std::memory_order_relaxed);
+  return popped;
+}
+
+void ConcurrentPoolAllocator::pushChain(u32 count, const u32 *objects) {
+  // the objects are owned by the caller, link them before publishing
+  for (u32 i = 0; i + 1 < count; ++i)
+    link(objects[i])->store(objects[i + 1], std::memory_order_relaxed);
+  auto *last = link(objects[count - 1]);
+  u64 head = head_.load(std::memory_order_relaxed);
+  do {
+    last->store(CPA_HEAD_INDEX(head), std::memory_order_relaxed);
+  } while (!head_.compare_exchange_weak(head, CPA_BUILD_HEAD(objects[0], (head >> 32u) + 1),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+  size_.fetch_sub(count, std::memory_order_relaxed);
+}
+
+std::atomic<u32> *ConcurrentPoolAllocator::link(u32 index) const {
+  return reinterpret_cast<std::atomic<u32> *>(data_ + static_cast<std::size_t>(index) * object_size_in_bytes_);
+}
+
+#undef CPA_HEAD_INDEX
+#undef CPA_BUILD_HEAD
+
+}
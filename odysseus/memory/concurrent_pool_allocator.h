@@ -0,0 +1,154 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file concurrent_pool_allocator.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_MEMORY_CONCURRENT_POOL_ALLOCATOR_H
+#define ODYSSEUS_ODYSSEUS_MEMORY_CONCURRENT_POOL_ALLOCATOR_H
+
+#include <odysseus/memory/mem.h>
+#include <atomic>
+
+namespace odysseus {
+
+/// RAII Lock-Free Pool Allocator
+/// Thread-safe version of the PoolAllocator. Free objects form the same
+/// in-place u32 linked list, but the list head is updated with
+/// compare-and-swap operations, so any number of threads can allocate and
+/// free objects from the same pool without locks.
+///
+/// \note Head Construction:
+/// \note The 64-bit head stores the index of the first free object in its
+/// lower 32 bits and a tag in its upper 32 bits. The tag is incremented on
+/// every head update, so a thread holding an old head value fails its
+/// compare-and-swap even if the same index returned to the top of the list
+/// in the meantime (ABA problem).
+///
+/// \note Thread Caches:
+/// \note Pools created with a thread_count get one magazine per thread, a
+/// small array of free object indices owned by the thread of that index
+/// (see mem::setThreadIndex). allocateCached and freeObjectCached only touch
+/// the magazine of the calling thread, and go to the shared list in bulk
+/// (a single compare-and-swap) to refill an empty magazine or to flush half
+/// of a full one. Objects are interchangeable, so objects freed by a thread
+/// other than the one that allocated them simply join its magazine.
+class ConcurrentPoolAllocator {
+public:
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  ConcurrentPoolAllocator() = default;
+  /// \note object_size_in_bytes is rounded up to a multiple of sizeof(u32)
+  /// \param object_size_in_bytes
+  /// \param object_count
+  /// \param context memory context objects and thread caches come from
+  /// \param thread_count number of thread caches (0 disables them)
+  ConcurrentPoolAllocator(u32 object_size_in_bytes, u32 object_count,
+                          mem::ContextType context = mem::ContextType::GENERAL_PURPOSE,
+                          u32 thread_count = 0);
+  ///
+  ~ConcurrentPoolAllocator();
+  ConcurrentPoolAllocator(const ConcurrentPoolAllocator &) = delete;
+  ConcurrentPoolAllocator &operator=(const ConcurrentPoolAllocator &) = delete;
+  /****************************************************************************
+                                    SIZE
+  ****************************************************************************/
+  /// \return total memory size in bytes
+  [[nodiscard]] u32 capacityInBytes() const;
+  /// \return capacity in number of objects
+  [[nodiscard]] u32 capacity() const;
+  /// \note The value may be outdated while other threads are operating.
+  /// \return number of allocated objects (objects held by thread caches are
+  /// not counted)
+  [[nodiscard]] u32 size() const;
+  /// \return
+  [[nodiscard]] u32 objectSizeInBytes() const;
+  /// \return number of thread caches
+  [[nodiscard]] u32 threadCount() const;
+  /****************************************************************************
+                                    ALLOCATION
+  ****************************************************************************/
+  /// Thread-safe
+  /// \return pointer to a free object, nullptr if the pool is full
+  void *allocate();
+  /// Thread-safe
+  /// \param ptr object previously returned by allocate
+  void freeObject(void *ptr);
+  /// Allocates from the cache of the given thread, refilling it from the
+  /// shared list when empty.
+  /// \note Only the thread of thread_index may use its cache.
+  /// \param thread_index
+  /// \return pointer to a free object, nullptr if the pool is full
+  void *allocateCached(u32 thread_index = mem::threadIndex());
+  /// Frees the object into the cache of the given thread, flushing half of
+  /// the cache to the shared list when full.
+  /// \note Only the thread of thread_index may use its cache.
+  /// \param ptr object previously returned by allocate or allocateCached
+  /// \param thread_index
+  void freeObjectCached(void *ptr, u32 thread_index = mem::threadIndex());
+  /// Returns every object cached by the thread to the shared list
+  /// \note Only the thread of thread_index (or any thread, once it is done)
+  /// may flush its cache.
+  /// \param thread_index
+  void flushCache(u32 thread_index = mem::threadIndex());
+
+  /// maximum number of objects cached per thread
+  static constexpr u32 magazine_size = 31;
+  /// number of objects moved between a cache and the shared list at once
+  static constexpr u32 magazine_batch_size = 16;
+
+private:
+  /// Free object indices cached by a single thread
+  struct alignas(64) Magazine {
+    std::atomic<u32> count{0};
+    u32 objects[magazine_size];
+  };
+  /// Pops up to count objects from the shared list
+  /// \param count
+  /// \param objects receives the object indices
+  /// \return number of objects popped
+  u32 popChain(u32 count, u32 *objects);
+  /// Pushes objects to the shared list
+  /// \param count
+  /// \param objects object indices
+  void pushChain(u32 count, const u32 *objects);
+  /// \param index
+  /// \return free list link stored in the object of the given index
+  [[nodiscard]] std::atomic<u32> *link(u32 index) const;
+
+  // head and size are written by all threads, keep them apart from each other
+  // and from the read-only fields
+  alignas(64) std::atomic<u64> head_{0};
+  alignas(64) std::atomic<u32> size_{0};
+  alignas(64) u32 capacity_{0};
+  u32 object_size_in_bytes_{0};
+  byte *data_{nullptr};
+  Magazine *magazines_{nullptr};
+  u32 thread_count_{0};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_MEMORY_CONCURRENT_POOL_ALLOCATOR_H
@@ -26,67 +26,75 @@
 ///\brief
 
 #include <odysseus/memory/double_stack_allocator.h>
+#include <algorithm>
 
 namespace odysseus {
 
-#define DSA_EXTRACT_MARKER(HANDLE) \
-  ((HANDLE & 0xffffff) - 1)
-
-#define DSA_BUILD_HANDLE(MARKER, SHIFT) \
-  ((MARKER + 1u) | (SHIFT << 24u))
-
-DoubleStackAllocator::DoubleStackAllocator(std::size_t capacity_in_bytes, byte *buffer) :
-    data_{buffer}, capacity_{capacity_in_bytes}, upper_marker_{capacity_in_bytes},
+template<class HandleLayout, class Tracking>
+BasicDoubleStackAllocator<HandleLayout, Tracking>::BasicDoubleStackAllocator(std::size_t capacity_in_bytes, byte *buffer) :
+    data_{buffer}, capacity_{std::min(capacity_in_bytes, HandleLayout::max_capacity)},
+    upper_marker_{capacity_}, threshold_{capacity_ + 1},
     using_extern_memory_{buffer != nullptr} {
-  if (!buffer)
+  if (!buffer) {
+    capacity_ = upper_marker_ = 0;
+    threshold_ = 1;
     resize(capacity_in_bytes);
+  }
 }
 
-DoubleStackAllocator::~DoubleStackAllocator() {
+template<class HandleLayout, class Tracking>
+BasicDoubleStackAllocator<HandleLayout, Tracking>::~BasicDoubleStackAllocator() {
   if (!using_extern_memory_)
     delete[] data_;
 }
 
-std::size_t DoubleStackAllocator::capacityInBytes() const {
+template<class HandleLayout, class Tracking>
+std::size_t BasicDoubleStackAllocator<HandleLayout, Tracking>::capacityInBytes() const {
   return capacity_;
 }
 
-std::size_t DoubleStackAllocator::availableLowerSizeInBytes() const {
+template<class HandleLayout, class Tracking>
+std::size_t BasicDoubleStackAllocator<HandleLayout, Tracking>::availableLowerSizeInBytes() const {
   if (threshold_ < capacity_)
     return threshold_ - lower_marker_;
   return upper_marker_ - lower_marker_;
 }
 
-std::size_t DoubleStackAllocator::availableUpperSizeInBytes() const {
+template<class HandleLayout, class Tracking>
+std::size_t BasicDoubleStackAllocator<HandleLayout, Tracking>::availableUpperSizeInBytes() const {
   if (threshold_ < capacity_)
     return upper_marker_ - threshold_;
   return upper_marker_ - lower_marker_;
 }
 
-OdResult DoubleStackAllocator::resize(std::size_t size_in_bytes) {
-  if (!using_extern_memory_)
-    delete[] data_;
-  else
+template<class HandleLayout, class Tracking>
+OdResult BasicDoubleStackAllocator<HandleLayout, Tracking>::resize(std::size_t size_in_bytes) {
+  if (using_extern_memory_)
     return OdResult::BAD_OPERATION;
+  if (size_in_bytes > HandleLayout::max_capacity)
+    return OdResult::OUT_OF_BOUNDS;
+  delete[] data_;
+  data_ = nullptr;
   if (size_in_bytes)
     data_ = new u8[size_in_bytes];
   capacity_ = size_in_bytes;
   threshold_ = capacity_ + 1;
   lower_marker_ = 0;
   upper_marker_ = size_in_bytes;
-  ODYSSEUS_DEBUG_CODE(odb_handles.clear();
-                          odb_regions.clear();)
+  tracking_.onClear();
   return OdResult::SUCCESS;
 }
 
-OdResult DoubleStackAllocator::setThreshold(std::size_t lower_stack_size_in_bytes) {
+template<class HandleLayout, class Tracking>
+OdResult BasicDoubleStackAllocator<HandleLayout, Tracking>::setThreshold(std::size_t lower_stack_size_in_bytes) {
   if (capacity_ < lower_stack_size_in_bytes)
     return OdResult::OUT_OF_BOUNDS;
   threshold_ = lower_stack_size_in_bytes;
   return OdResult::SUCCESS;
 }
 
-MemHandle DoubleStackAllocator::allocateLower(u64 block_size_in_bytes, std::size_t align) {
+template<class HandleLayout, class Tracking>
+MemHandle BasicDoubleStackAllocator<HandleLayout, Tracking>::allocateLower(u64 block_size_in_bytes, std::size_t align) {
   std::size_t actual_size =
       block_size_in_bytes + mem::rightAlignShift(reinterpret_cast<uintptr_t >(data_ ) + lower_marker_, align);
   std::size_t shift = actual_size - block_size_in_bytes;
@@ -95,19 +103,12 @@ MemHandle DoubleStackAllocator::allocateLower(u64 block_size_in_bytes, std::size
     return {0};
   const auto marker = lower_marker_;
   lower_marker_ += actual_size;
-  ODYSSEUS_DEBUG_CODE(odb_handles.emplace_back(marker);
-                          odb_regions.push_back({
-                                                    marker,
-                                                    actual_size,
-                                                    1,
-                                                    ponos::ConsoleColors::color(odb_handles.size()),
-                                                    {}
-                                                });
-  )
-  return {DSA_BUILD_HANDLE(marker + shift, shift)};
+  tracking_.onAllocate(marker, actual_size);
+  return {HandleLayout::build(marker + shift, shift)};
 }
 
-MemHandle DoubleStackAllocator::allocateUpper(u64 block_size_in_bytes, std::size_t align) {
+template<class HandleLayout, class Tracking>
+MemHandle BasicDoubleStackAllocator<HandleLayout, Tracking>::allocateUpper(u64 block_size_in_bytes, std::size_t align) {
   if (block_size_in_bytes > upper_marker_ ||
       upper_marker_ - block_size_in_bytes < lower_marker_ ||
       (threshold_ < capacity_ && upper_marker_ - block_size_in_bytes < threshold_))
@@ -120,52 +121,48 @@ MemHandle DoubleStackAllocator::allocateUpper(u64 block_size_in_bytes, std::size
       (threshold_ < capacity_ && upper_marker_ - actual_size < threshold_))
     return {0};
   upper_marker_ -= actual_size;
-  ODYSSEUS_DEBUG_CODE(odb_handles.emplace_back(upper_marker_);
-                          odb_regions.push_back({
-                                                    upper_marker_,
-                                                    actual_size,
-                                                    1,
-                                                    ponos::ConsoleColors::color(odb_handles.size()),
-                                                    {}
-                                                });
-  )
-  return {DSA_BUILD_HANDLE(upper_marker_ + shift, shift)};
+  tracking_.onAllocate(upper_marker_, actual_size);
+  return {HandleLayout::build(upper_marker_ + shift, shift)};
 }
 
-OdResult DoubleStackAllocator::freeToUpperMarker(MemHandle handle) {
+template<class HandleLayout, class Tracking>
+OdResult BasicDoubleStackAllocator<HandleLayout, Tracking>::freeToUpperMarker(MemHandle handle) {
   if (upper_marker_ == capacity_)
     return OdResult::BAD_OPERATION;
   if (!handle.id)
     return OdResult::INVALID_INPUT;
-  upper_marker_ = DSA_EXTRACT_MARKER(handle.id);
+  upper_marker_ = HandleLayout::extractMarker(handle.id);
   return OdResult::SUCCESS;
 }
 
-OdResult DoubleStackAllocator::freeToLowerMarker(MemHandle handle) {
+template<class HandleLayout, class Tracking>
+OdResult BasicDoubleStackAllocator<HandleLayout, Tracking>::freeToLowerMarker(MemHandle handle) {
   if (!lower_marker_)
     return OdResult::BAD_OPERATION;
   if (!handle.id)
     return OdResult::INVALID_INPUT;
-  lower_marker_ = DSA_EXTRACT_MARKER(handle.id);
+  lower_marker_ = HandleLayout::extractMarker(handle.id);
   return OdResult::SUCCESS;
 }
 
-void DoubleStackAllocator::clear() {
-  ODYSSEUS_DEBUG_CODE(odb_handles.clear();
-                          odb_regions.clear();)
+template<class HandleLayout, class Tracking>
+void BasicDoubleStackAllocator<HandleLayout, Tracking>::clear() {
+  tracking_.onClear();
   lower_marker_ = 0;
   upper_marker_ = capacity_;
 }
 
 #ifdef ODYSSEUS_DEBUG
-void DoubleStackAllocator::dump(std::size_t start, std::size_t size) const {
+template<class HandleLayout, class Tracking>
+void BasicDoubleStackAllocator<HandleLayout, Tracking>::dump(std::size_t start, std::size_t size) const {
   ponos::MemoryDumper::dump(data_ + start, size ? size : capacity_ - start,
                             64, ponos::memory_dumper_options::colored_output
                                 | ponos::memory_dumper_options::cache_align,
-                            odb_regions);
+                            getDataRegions());
 }
 
-std::vector<ponos::MemoryDumper::Region> DoubleStackAllocator::getRegions() {
+template<class HandleLayout, class Tracking>
+std::vector<ponos::MemoryDumper::Region> BasicDoubleStackAllocator<HandleLayout, Tracking>::getRegions() {
   std::vector<ponos::MemoryDumper::Region> regions = {
       { // data_
           0,
@@ -182,57 +179,58 @@ std::vector<ponos::MemoryDumper::Region> DoubleStackAllocator::getRegions() {
           {}
       },
       { // lower marker_
-          offsetof(DoubleStackAllocator, lower_marker_),
+          offsetof(BasicDoubleStackAllocator, lower_marker_),
           sizeof(lower_marker_),
           1,
           ponos::ConsoleColors::color(3),
           {}
       },
       { // upper marker_
-          offsetof(DoubleStackAllocator, upper_marker_),
+          offsetof(BasicDoubleStackAllocator, upper_marker_),
           sizeof(upper_marker_),
           1,
           ponos::ConsoleColors::color(4),
           {}
       },
       { // threshold_
-          offsetof(DoubleStackAllocator, threshold_),
+          offsetof(BasicDoubleStackAllocator, threshold_),
           sizeof(threshold_),
           1,
           ponos::ConsoleColors::color(5),
           {}
       },
       { // using_exten_memory_
-          offsetof(DoubleStackAllocator, using_extern_memory_),
+          offsetof(BasicDoubleStackAllocator, using_extern_memory_),
           sizeof(using_extern_memory_),
           1,
           ponos::ConsoleColors::color(6),
           {}
       },
-      { // db_handles
-          offsetof(DoubleStackAllocator, odb_handles),
-          sizeof(odb_handles),
+      { // tracking_
+          offsetof(BasicDoubleStackAllocator, tracking_),
+          sizeof(tracking_),
           1,
           ponos::ConsoleColors::color(7),
           {}
       },
-      { // db_regions
-          offsetof(DoubleStackAllocator, odb_regions),
-          sizeof(odb_regions),
-          1,
-          ponos::ConsoleColors::color(8),
-          {}
-      },
   };
   return std::move(regions);
 }
 
-std::vector<ponos::MemoryDumper::Region> DoubleStackAllocator::getDataRegions() {
-  return odb_regions;
+template<class HandleLayout, class Tracking>
+std::vector<ponos::MemoryDumper::Region> BasicDoubleStackAllocator<HandleLayout, Tracking>::getDataRegions() const {
+  if constexpr (Tracking::keeps_regions)
+    return tracking_.regions();
+  else
+    return {};
 }
 #endif
 
-#undef DSA_BUILD_HANDLE
-#undef DSA_EXTRACT_MARKER
+template class BasicDoubleStackAllocator<SmallMemHandleLayout, NoTracking>;
+template class BasicDoubleStackAllocator<SmallMemHandleLayout, CountTracking>;
+template class BasicDoubleStackAllocator<SmallMemHandleLayout, RegionTracking>;
+template class BasicDoubleStackAllocator<WideMemHandleLayout, NoTracking>;
+template class BasicDoubleStackAllocator<WideMemHandleLayout, CountTracking>;
+template class BasicDoubleStackAllocator<WideMemHandleLayout, RegionTracking>;
 
 }
\ No newline at end of file
@@ -32,12 +32,6 @@
 
 namespace odysseus {
 
-#define DSA_EXTRACT_MARKER(HANDLE) \
-  ((HANDLE & 0xffffff) - 1)
-
-#define DSA_BUILD_HANDLE(MARKER, SHIFT) \
-  ((MARKER + 1u) | (SHIFT << 24u))
-
 /// RAII Double Stack Allocator
 ///
 /// Manages two stacks stored in a single memory block, the LOWER stack and
@@ -52,16 +46,24 @@ namespace odysseus {
 /// In a memory block of N + 1 bytes, the LOWER stack occupies the range
 /// [0, L) and the UPPER stack occupies (U, N]. It is possible to define a
 /// limiting threshold T to limit the individual capacity of both stacks.
-class DoubleStackAllocator {
+///
+/// \note Handles are built as in BasicStackAllocator, following HandleLayout.
+/// \tparam HandleLayout a MemHandleLayout, only SmallMemHandleLayout and
+/// WideMemHandleLayout are instantiated (see double_stack_allocator.cpp)
+/// \tparam Tracking allocation tracking policy (see allocation_tracking.h)
+template<class HandleLayout, class Tracking>
+class BasicDoubleStackAllocator {
 public:
+  /// largest capacity the handle layout can address
+  static constexpr std::size_t max_capacity = HandleLayout::max_capacity;
   /****************************************************************************
                                  CONSTRUCTORS
   ****************************************************************************/
   /// \param capacity_in_bytes total memory capacity
   /// \param context
-  explicit DoubleStackAllocator(std::size_t capacity_in_bytes = 0, byte *buffer = nullptr);
+  explicit BasicDoubleStackAllocator(std::size_t capacity_in_bytes = 0, byte *buffer = nullptr);
   ///
-  ~DoubleStackAllocator();
+  ~BasicDoubleStackAllocator();
   /****************************************************************************
                                     SIZE
   ****************************************************************************/
@@ -73,10 +75,16 @@ public:
   [[nodiscard]] std::size_t availableUpperSizeInBytes() const;
   /// All previous data is deleted and markers get invalid
   /// \param size_in_bytes total memory capacity
+  /// \return OUT_OF_BOUNDS if the size can't be addressed by the handle layout
   OdResult resize(std::size_t size_in_bytes);
   /// \param lower_stack_size_in_bytes a value grater than capacity removes the
   /// threshold
   OdResult setThreshold(std::size_t lower_stack_size_in_bytes);
+  /// \param ptr
+  /// \return true if ptr points into the memory of any of the stacks
+  [[nodiscard]] inline bool owns(const void *ptr) const {
+    return ptr >= data_ && ptr < data_ + capacity_;
+  }
   /****************************************************************************
                                     ALLOCATION
   ****************************************************************************/
@@ -94,7 +102,7 @@ public:
     auto handle = allocateLower(sizeof(T), alignof(T));
     if (!handle.id)
       return handle;
-    T *ptr = reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1));
+    T *ptr = reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id));
     new(ptr) T(std::forward<P>(params)...);
     return handle;
   }
@@ -112,7 +120,7 @@ public:
     auto handle = allocateUpper(sizeof(T), alignof(T));
     if (!handle.id)
       return handle;
-    T *ptr = reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1));
+    T *ptr = reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id));
     new(ptr) T(std::forward<P>(params)...);
     return handle;
   }
@@ -129,12 +137,9 @@ public:
   /// \return
   template<typename T>
   OdResult set(MemHandle handle, const T &value) {
-    std::cerr << " handle " << handle.id << std::endl;
-    if (handle.id == 0 || handle.id >= capacity_)
+    if (handle.id == 0 || HandleLayout::extractMarker(handle.id) >= capacity_)
       return OdResult::INVALID_INPUT;
-    std::cerr << handle.id << std::endl;
-    std::cerr << "====" << ((handle.id & 0xffffff) - 1) << " " <<  value << std::endl;
-    *reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1)) = value;
+    *reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id)) = value;
     return OdResult::SUCCESS;
   }
   ///
@@ -144,9 +149,9 @@ public:
   /// \return
   template<typename T>
   OdResult set(MemHandle handle, T &&value) {
-    if (handle.id == 0 || handle.id >= capacity_)
+    if (handle.id == 0 || HandleLayout::extractMarker(handle.id) >= capacity_)
       return OdResult::INVALID_INPUT;
-    *reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1)) = std::forward<T>(value);
+    *reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id)) = std::forward<T>(value);
     return OdResult::SUCCESS;
   }
   ///
@@ -155,16 +160,18 @@ public:
   /// \return
   template<typename T>
   T *get(MemHandle handle) {
-    ASSERT(handle.id > 0 && ((handle.id & 0xffffff) - 1) < capacity_)
-    return reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1));
+    ASSERT(handle.id > 0 && HandleLayout::extractMarker(handle.id) < capacity_)
+    return reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id));
   }
 
   /****************************************************************************
                                    DEBUG
   ****************************************************************************/
+  /// \return tracking policy state
+  [[nodiscard]] const Tracking &tracking() const { return tracking_; }
 #ifdef ODYSSEUS_DEBUG
   void dump(std::size_t start = 0, std::size_t size = 0) const;
-  std::vector<ponos::MemoryDumper::Region> getDataRegions();
+  std::vector<ponos::MemoryDumper::Region> getDataRegions() const;
   [[nodiscard]]static std::vector<ponos::MemoryDumper::Region> getRegions();
 #endif
 
@@ -175,15 +182,13 @@ private:
   std::size_t upper_marker_{0};
   std::size_t threshold_{0};
   bool using_extern_memory_{false};
-
-#ifdef ODYSSEUS_DEBUG
-  std::vector<std::size_t> odb_handles;
-  std::vector<ponos::MemoryDumper::Region> odb_regions;
-#endif
+  Tracking tracking_;
 };
 
-#undef DSA_BUILD_HANDLE
-#undef DSA_EXTRACT_MARKER
+/// Double stack allocator of up to 16 MB
+using DoubleStackAllocator = BasicDoubleStackAllocator<SmallMemHandleLayout, DefaultTracking>;
+/// Double stack allocator for large (> 16 MB) memory blocks
+using WideDoubleStackAllocator = BasicDoubleStackAllocator<WideMemHandleLayout, DefaultTracking>;
 
 }
 
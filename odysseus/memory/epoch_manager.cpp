@@ -0,0 +1,156 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file epoch_manager.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/memory/epoch_manager.h>
+#include <odysseus/memory/pool_allocator.h>
+#include <odysseus/memory/concurrent_pool_allocator.h>
+
+namespace odysseus {
+
+OdResult EpochManager::init(u32 thread_count, mem::ContextType context) {
+  release();
+  auto &instance = get();
+  auto *records = reinterpret_cast<ThreadRecord *>(
+      mem::allocateBlock(sizeof(ThreadRecord) * thread_count, context, alignof(ThreadRecord)));
+  if (!records)
+    return OdResult::BAD_ALLOCATION;
+  for (u32 i = 0; i < thread_count; ++i)
+    new(records + i) ThreadRecord();
+  instance.records_ = records;
+  instance.thread_count_ = thread_count;
+  return OdResult::SUCCESS;
+}
+
+void EpochManager::release() {
+  auto &instance = get();
+  for (u32 bucket = 0; bucket < 3; ++bucket)
+    instance.reclaim(bucket);
+  for (u32 i = 0; i < instance.thread_count_; ++i) {
+    ASSERT(!instance.records_[i].nesting)
+    instance.records_[i].~ThreadRecord();
+  }
+  mem::freeBlock(instance.records_);
+  instance.records_ = nullptr;
+  instance.thread_count_ = 0;
+}
+
+void EpochManager::pin(u32 thread_index) {
+  auto &instance = get();
+  ASSERT(thread_index < instance.thread_count_)
+  auto &record = instance.records_[thread_index];
+  if (record.nesting++)
+    return;
+  // publish the pin before reading shared nodes, and make sure the epoch
+  // we published is still current (advance may have missed our pin)
+  u64 epoch = instance.epoch_.load(std::memory_order_relaxed);
+  while (true) {
+    // release: objects we retired under an older pin become visible to
+    // the advance that sees this one
+    record.pinned.store((epoch << 1u) | 1u, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const u64 current = instance.epoch_.load(std::memory_order_relaxed);
+    if (current == epoch)
+      break;
+    epoch = current;
+  }
+}
+
+void EpochManager::unpin(u32 thread_index) {
+  auto &record = get().records_[thread_index];
+  ASSERT(record.nesting)
+  if (!--record.nesting)
+    record.pinned.store(0, std::memory_order_release);
+}
+
+bool EpochManager::isPinned(u32 thread_index) {
+  auto &instance = get();
+  return thread_index < instance.thread_count_ && instance.records_[thread_index].nesting;
+}
+
+void EpochManager::retire(void *object, ReclaimFunction reclaim, void *owner, u32 thread_index) {
+  auto &instance = get();
+  auto &record = instance.records_[thread_index];
+  ASSERT(record.nesting)
+  // tag with the global epoch: readers pinned at it may have reached the
+  // object before it was unlinked, our own pin may be one epoch older.
+  // While we are pinned the global epoch is at most one ahead of our pin,
+  // so advance never reclaims the list we append to
+  const u64 epoch = instance.epoch_.load(std::memory_order_seq_cst);
+  record.retired[epoch % 3].push_back({object, reclaim, owner});
+}
+
+void EpochManager::retire(PoolAllocator &pool, void *object, u32 thread_index) {
+  retire(object, [](void *owner, void *ptr) {
+    reinterpret_cast<PoolAllocator *>(owner)->freeObject(ptr);
+  }, &pool, thread_index);
+}
+
+void EpochManager::retire(ConcurrentPoolAllocator &pool, void *object, u32 thread_index) {
+  retire(object, [](void *owner, void *ptr) {
+    reinterpret_cast<ConcurrentPoolAllocator *>(owner)->freeObject(ptr);
+  }, &pool, thread_index);
+}
+
+bool EpochManager::advance() {
+  auto &instance = get();
+  const u64 epoch = instance.epoch_.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  for (u32 i = 0; i < instance.thread_count_; ++i) {
+    const u64 pinned = instance.records_[i].pinned.load(std::memory_order_acquire);
+    if (pinned && (pinned >> 1u) != epoch)
+      return false;
+  }
+  instance.epoch_.store(epoch + 1, std::memory_order_seq_cst);
+  // objects retired while the global epoch was epoch - 1 were unlinked
+  // before every current pin
+  instance.reclaim((epoch + 2) % 3);
+  return true;
+}
+
+u64 EpochManager::epoch() {
+  return get().epoch_.load(std::memory_order_relaxed);
+}
+
+std::size_t EpochManager::pendingCount() {
+  auto &instance = get();
+  std::size_t count = 0;
+  for (u32 i = 0; i < instance.thread_count_; ++i)
+    for (auto &retired : instance.records_[i].retired)
+      count += retired.size();
+  return count;
+}
+
+void EpochManager::reclaim(u32 bucket) {
+  for (u32 i = 0; i < thread_count_; ++i) {
+    auto &retired = records_[i].retired[bucket];
+    for (auto &r : retired)
+      r.reclaim(r.owner, r.object);
+    retired.clear();
+  }
+}
+
+}
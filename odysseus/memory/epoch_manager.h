@@ -0,0 +1,170 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file epoch_manager.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_MEMORY_EPOCH_MANAGER_H
+#define ODYSSEUS_ODYSSEUS_MEMORY_EPOCH_MANAGER_H
+
+#include <odysseus/memory/mem.h>
+#include <atomic>
+#include <vector>
+
+namespace odysseus {
+
+class PoolAllocator;
+class ConcurrentPoolAllocator;
+
+/// Epoch-Based Memory Reclamation Singleton
+/// Lets lock-free containers release nodes that concurrent readers may
+/// still be holding. Readers pin the current epoch (see EpochGuard) while
+/// they access shared nodes, writers retire unlinked nodes instead of
+/// freeing them, and the frame boundary (advance) moves the global epoch
+/// and returns to their pools the nodes no reader can reach anymore.
+///
+/// \note A node retired while the global epoch is e is reclaimed once the
+/// global epoch reaches e + 2: the epoch only advances when every pinned
+/// thread has observed it, so no thread pinned at e or before (the only
+/// ones that could have reached the node before it was unlinked) is left
+/// by then. Nodes are tagged with the global epoch, not with the pinned
+/// epoch of the retiring thread, which may be one step behind.
+/// \note Threads are identified by mem::threadIndex(). Each thread keeps
+/// its pinned epoch in its own cache line and appends retired nodes to its
+/// own lists (one per epoch modulo 3), so pinning and retiring need no
+/// locks or shared read-modify-write operations.
+/// \note advance must be called by a single thread (usually at the frame
+/// boundary) and runs the reclaim functions on that thread, so nodes can go
+/// back to pools that are not thread-safe (PoolAllocator) as long as that
+/// thread owns them.
+class EpochManager {
+public:
+  /// Returns a retired object to its owner
+  using ReclaimFunction = void (*)(void *owner, void *object);
+  /****************************************************************************
+                                 INITIALIZATION
+  ****************************************************************************/
+  /// Creates one record per thread. Pending objects are reclaimed first.
+  /// \param thread_count number of threads that may pin and retire
+  /// \param context memory context the records are allocated from
+  /// \return BAD_ALLOCATION if records could not be allocated
+  static OdResult init(u32 thread_count,
+                       mem::ContextType context = mem::ContextType::GENERAL_PURPOSE);
+  /// Reclaims every pending object and frees all records
+  /// \note No thread may be pinned.
+  static void release();
+  /****************************************************************************
+                                   READERS
+  ****************************************************************************/
+  /// Pins the current epoch, nodes reachable from now on stay valid until
+  /// unpin. Pins nest.
+  /// \param thread_index
+  static void pin(u32 thread_index = mem::threadIndex());
+  /// \param thread_index
+  static void unpin(u32 thread_index = mem::threadIndex());
+  /// \param thread_index
+  /// \return true if the thread is pinned
+  static bool isPinned(u32 thread_index = mem::threadIndex());
+  /****************************************************************************
+                                   WRITERS
+  ****************************************************************************/
+  /// Defers the release of an unlinked object
+  /// \note The calling thread must be pinned.
+  /// \param object
+  /// \param reclaim called with owner and object once no reader holds it
+  /// \param owner
+  /// \param thread_index
+  static void retire(void *object, ReclaimFunction reclaim, void *owner,
+                     u32 thread_index = mem::threadIndex());
+  /// Defers pool.freeObject(object)
+  /// \param pool
+  /// \param object
+  /// \param thread_index
+  static void retire(PoolAllocator &pool, void *object, u32 thread_index = mem::threadIndex());
+  /// Defers pool.freeObject(object)
+  /// \param pool
+  /// \param object
+  /// \param thread_index
+  static void retire(ConcurrentPoolAllocator &pool, void *object,
+                     u32 thread_index = mem::threadIndex());
+  /****************************************************************************
+                                 FRAME BOUNDARY
+  ****************************************************************************/
+  /// Moves the global epoch forward if every pinned thread has observed it,
+  /// then reclaims the objects retired two epochs ago.
+  /// \note Must be called by a single thread.
+  /// \return true if the epoch advanced
+  static bool advance();
+  /// \return global epoch
+  static u64 epoch();
+  /// \return number of retired objects not reclaimed yet
+  static std::size_t pendingCount();
+
+  EpochManager &operator=(const EpochManager &) = delete;
+
+private:
+  struct Retired {
+    void *object;
+    ReclaimFunction reclaim;
+    void *owner;
+  };
+  struct alignas(64) ThreadRecord {
+    /// pinned epoch shifted left by one with the lowest bit set, 0 when the
+    /// thread is not pinned
+    std::atomic<u64> pinned{0};
+    u32 nesting{0};
+    std::vector<Retired> retired[3];
+  };
+
+  EpochManager() = default;
+  static inline EpochManager &get() {
+    static EpochManager singleton;
+    return singleton;
+  }
+  /// Reclaims the objects retired during epochs congruent to bucket mod 3
+  void reclaim(u32 bucket);
+
+  ThreadRecord *records_{nullptr};
+  u32 thread_count_{0};
+  alignas(64) std::atomic<u64> epoch_{1};
+};
+
+/// Scoped epoch pin
+class EpochGuard {
+public:
+  /// \param thread_index
+  explicit EpochGuard(u32 thread_index = mem::threadIndex()) : thread_index_{thread_index} {
+    EpochManager::pin(thread_index_);
+  }
+  ~EpochGuard() { EpochManager::unpin(thread_index_); }
+  EpochGuard(const EpochGuard &) = delete;
+  EpochGuard &operator=(const EpochGuard &) = delete;
+
+private:
+  u32 thread_index_;
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_MEMORY_EPOCH_MANAGER_H
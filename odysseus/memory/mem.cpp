@@ -28,12 +28,47 @@
 #include <odysseus/memory/mem.h>
 #include <ponos/log/memory_dump.h>
 #include <odysseus/memory/stack_allocator.h>
+#include <odysseus/memory/tlsf_allocator.h>
+#include <odysseus/memory/small_object_allocator.h>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define ODYSSEUS_HAS_MMAP
+#endif
 
 namespace odysseus {
 
 [[maybe_unused]] u32 mem::cache_l1_size = 64;
+thread_local u32 mem::thread_index_ = 0;
+thread_local mem::ContextCacheEntry mem::context_cache_[mem::context_cache_size];
+
+namespace {
+
+constexpr u64 context_hash_seed = 14695981039346656037ull;
+
+// FNV-1a, so hashing "a/b" equals hashing "b" on top of the hash of "a/"
+u64 hashContextName(u64 hash, const char *name) {
+  for (; *name; ++name)
+    hash = (hash ^ static_cast<u8>(*name)) * 1099511628211ull;
+  return hash;
+}
+
+}
 
 void *mem::allocAligned(size_t size, size_t align) {
+  // alignments up to 128 bytes store the shift in the byte right before the
+  // aligned block, larger alignments flag that byte with 0xFF and store the
+  // whole shift value in the sizeof(size_t) bytes before it
+  if (align > 128) {
+    u8 *p_raw_mem = new u8[size + align + sizeof(size_t)];
+    u8 *p_aligned_mem = alignPointer(p_raw_mem + sizeof(size_t) + 1, align);
+    size_t shift = p_aligned_mem - p_raw_mem;
+    std::memcpy(p_aligned_mem - 1 - sizeof(size_t), &shift, sizeof(size_t));
+    p_aligned_mem[-1] = 0xFF;
+    return p_aligned_mem;
+  }
   // allocate align more bytes to store shift value
   size_t actual_bytes = size + align;
   // allocate unaligned block
@@ -46,8 +81,7 @@ void *mem::allocAligned(size_t size, size_t align) {
     p_aligned_mem += align;
   // determine the shift and store it
   ptrdiff_t shift = p_aligned_mem - p_raw_mem;
-  // alignment can't be greater than 256
-  ASSERT(shift > 0 && shift <= 256)
+  ASSERT(shift > 0 && shift <= 128)
   p_aligned_mem[-1] = static_cast<u8>(shift & 0xFF);
   return p_aligned_mem;
 }
@@ -56,9 +90,9 @@ void mem::freeAligned(void *p_mem) {
   if (p_mem) {
     u8 *p_aligned_mem = reinterpret_cast<u8 *>(p_mem);
     // extract the shift
-    ptrdiff_t shift = p_aligned_mem[-1];
-    if (shift == 0)
-      shift = 256;
+    size_t shift = p_aligned_mem[-1];
+    if (shift == 0xFF)
+      std::memcpy(&shift, p_aligned_mem - 1 - sizeof(size_t), sizeof(size_t));
     // back up to the actual allocated address and array-delete it
     u8 *p_raw_mem = p_aligned_mem - shift;
     delete[] p_raw_mem;
@@ -66,25 +100,489 @@ void mem::freeAligned(void *p_mem) {
 }
 
 mem::~mem() {
-  delete[] reinterpret_cast<u8 *>(buffer_);
+  destroyContexts(0);
+  releaseBuffer();
+}
+
+void mem::releaseBuffer() {
+#ifdef ODYSSEUS_HAS_MMAP
+  if (mapping_)
+    munmap(mapping_, mapping_size_);
+  else
+#endif
+    delete[] reinterpret_cast<u8 *>(buffer_);
+  buffer_ = nullptr;
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  huge_pages_ = false;
 }
 
 OdResult mem::init(std::size_t size_in_bytes) {
+  return init(size_in_bytes, {false, false, 0});
+}
+
+OdResult mem::init(std::size_t size_in_bytes, const InitOptions &options) {
   auto &instance = get();
-  instance.buffer_ = new u8[size_in_bytes];
+  std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+  // release previous buffer and its contexts
+  instance.destroyContexts(0);
+  instance.releaseBuffer();
+  // slot generations are kept, so ids from the previous buffer stay stale
+  instance.context_count_.store(0, std::memory_order_release);
+  instance.path_size_ = 0;
+  instance.general_purpose_ = nullptr;
+  instance.small_objects_ = nullptr;
+  instance.frame_arenas_ = nullptr;
+  instance.frame_thread_count_ = 0;
+  instance.frame_index_ = 0;
+  instance.in_frame_ = false;
+  instance.next_ = nullptr;
+  instance.size_ = 0;
+  ODYSSEUS_DEBUG_CODE(instance.odb_regions.clear();
+                          instance.odb_context_allocators.clear();)
+#ifdef ODYSSEUS_HAS_MMAP
+  if (options.use_virtual_memory) {
+    // huge pages are 2MB on most systems, over-map so the buffer can start
+    // on a huge page boundary
+    const std::size_t huge_page_size = 2u << 20u;
+#ifdef MAP_HUGETLB
+    if (options.huge_pages) {
+      instance.mapping_size_ = alignTo(size_in_bytes, huge_page_size);
+      instance.mapping_ = mmap(nullptr, instance.mapping_size_, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      instance.huge_pages_ = instance.mapping_ != MAP_FAILED;
+    }
+#endif
+    if (!instance.huge_pages_) {
+      // map whole huge pages so the advised range stays inside the mapping
+      instance.mapping_size_ = options.huge_pages ? alignTo(size_in_bytes, huge_page_size) + huge_page_size
+                                                  : size_in_bytes;
+      instance.mapping_ = mmap(nullptr, instance.mapping_size_, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (instance.mapping_ == MAP_FAILED) {
+      instance.mapping_ = nullptr;
+      instance.mapping_size_ = 0;
+      return OdResult::BAD_ALLOCATION;
+    }
+    instance.buffer_ = reinterpret_cast<byte *>(instance.mapping_);
+    if (options.huge_pages && !instance.huge_pages_) {
+      // let transparent huge pages back the aligned part of the buffer
+      instance.buffer_ = alignPointer(instance.buffer_, huge_page_size);
+#ifdef MADV_HUGEPAGE
+      madvise(instance.buffer_, alignTo(size_in_bytes, huge_page_size), MADV_HUGEPAGE);
+#endif
+    }
+  } else
+#endif
+    instance.buffer_ = new u8[size_in_bytes];
   if (!instance.buffer_)
     return OdResult::BAD_ALLOCATION;
   instance.next_ = instance.buffer_;
   instance.size_ = size_in_bytes;
+  if (options.prefault_thread_count) {
+    // write a byte in every page, each thread takes a contiguous range
+    const std::size_t page_size = instance.huge_pages_ ? (2u << 20u) : 4096u;
+    const std::size_t page_count = (size_in_bytes + page_size - 1) / page_size;
+    const std::size_t pages_per_thread = (page_count + options.prefault_thread_count - 1)
+        / options.prefault_thread_count;
+    auto *buffer = reinterpret_cast<volatile byte *>(instance.buffer_);
+    std::vector<std::thread> threads;
+    for (std::size_t first = 0; first < page_count; first += pages_per_thread)
+      threads.emplace_back([=]() {
+        for (std::size_t page = first; page < std::min(first + pages_per_thread, page_count); ++page)
+          buffer[page * page_size] = 0;
+      });
+    for (auto &thread : threads)
+      thread.join();
+  }
   return OdResult::SUCCESS;
 }
 
+bool mem::usingHugePages() {
+  return get().huge_pages_;
+}
+
 std::size_t mem::availableSize() {
   auto &instance = get();
   return instance.size_ - (reinterpret_cast<uintptr_t>(instance.next_) -
       reinterpret_cast<uintptr_t>(instance.buffer_));
 }
 
+mem::ContextId mem::pushRegion(const char *name, std::size_t size_in_bytes, ContextId parent) {
+  auto &instance = get();
+  std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+  u32 index = 0;
+  // regions start on their own cache line
+  if (instance.carveContext(name, size_in_bytes, cache_l1_size, parent, true, index)
+      != OdResult::SUCCESS)
+    return {};
+#ifdef ODYSSEUS_DEBUG
+  auto &context = instance.contexts_[index];
+  instance.odb_regions.push_back({
+                                     reinterpret_cast<uintptr_t>(context.ptr)
+                                         - reinterpret_cast<uintptr_t>(instance.buffer_),
+                                     size_in_bytes,
+                                     1,
+                                     ponos::ConsoleColors::color(instance.odb_regions.size() + 1),
+                                     {}
+                                 });
+#endif
+  return instance.publishContext(index);
+}
+
+OdResult mem::popContext(ContextId id) {
+  auto &instance = get();
+  std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+  if (!isAlive(id))
+    return OdResult::INVALID_INPUT;
+  auto &context = instance.contexts_[id.index];
+  // only contexts on the current path have no younger relatives
+  if (context.depth >= instance.path_size_ || instance.path_[context.depth] != id.index)
+    return OdResult::BAD_OPERATION;
+  // contexts created after this one are its descendants
+  instance.destroyContexts(id.index);
+  byte *&marker = context.depth ? instance.contexts_[context.parent].next : instance.next_;
+  marker = context.carve_begin;
+  // the path is now the youngest remaining context and its ancestors
+  instance.path_size_ = 0;
+  if (id.index) {
+    u32 index = id.index - 1;
+    instance.path_size_ = instance.contexts_[index].depth + 1;
+    for (u32 depth = instance.path_size_; depth-- > 0; index = instance.contexts_[index].parent)
+      instance.path_[depth] = index;
+  }
+  instance.context_count_.store(id.index, std::memory_order_release);
+#ifdef ODYSSEUS_DEBUG
+  instance.odb_regions.resize(context.odb_region_count);
+  instance.odb_context_allocators.erase(
+      std::remove_if(instance.odb_context_allocators.begin(),
+                     instance.odb_context_allocators.end(),
+                     [&](const ContextAllocatorInfo &info) {
+                       return info.region_index >= context.odb_region_count;
+                     }), instance.odb_context_allocators.end());
+#endif
+  return OdResult::SUCCESS;
+}
+
+mem::ContextId mem::findContext(const char *path) {
+  const u64 hash = hashContextName(context_hash_seed, path);
+  auto &entry = context_cache_[hash % context_cache_size];
+  // a cached id is still the same context while its generation holds
+  if (entry.hash == hash && isAlive(entry.id))
+    return entry.id;
+  auto &instance = get();
+  std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+  const u32 count = instance.context_count_.load(std::memory_order_relaxed);
+  for (u32 i = 0; i < count; ++i) {
+    auto &context = instance.contexts_[i];
+    if (context.path_hash == hash && context.name[0]) {
+      entry.hash = hash;
+      entry.id = {i, context.generation.load(std::memory_order_relaxed)};
+      return entry.id;
+    }
+  }
+  return {};
+}
+
+bool mem::isAlive(ContextId id) {
+  auto &instance = get();
+  return id.isValid() && id.index < instance.context_count_.load(std::memory_order_acquire)
+      && instance.contexts_[id.index].generation.load(std::memory_order_acquire) == id.generation;
+}
+
+std::size_t mem::availableSize(ContextId region) {
+  auto &instance = get();
+  std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+  if (!isAlive(region) || !instance.contexts_[region.index].is_region)
+    return 0;
+  auto &context = instance.contexts_[region.index];
+  return context.size - (context.next - context.ptr);
+}
+
+OdResult mem::createContext(const char *name, std::size_t size_in_bytes, ContextId parent,
+                            const ContextAllocator &allocator, std::size_t align, ContextId &id) {
+  // allocators constructed on external buffers can't report errors
+  if (size_in_bytes > allocator.max_size)
+    return OdResult::OUT_OF_BOUNDS;
+  u32 index = 0;
+  auto result = carveContext(name, allocator.object_size + size_in_bytes, align, parent, false, index);
+  if (result != OdResult::SUCCESS)
+    return result;
+  byte *ptr = contexts_[index].ptr;
+  allocator.construct(ptr, size_in_bytes);
+  contexts_[index].destroy = allocator.destroy;
+#ifdef ODYSSEUS_DEBUG
+  odb_regions.push_back({
+                            reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(buffer_),
+                            allocator.object_size,
+                            1,
+                            ponos::ConsoleColors::color(odb_regions.size() + 1),
+                            allocator.regions()
+                        });
+  odb_regions.push_back({
+                            reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(buffer_)
+                                + allocator.object_size,
+                            size_in_bytes,
+                            1,
+                            ponos::ConsoleColors::color(odb_regions.size() + 1),
+                            {}
+                        });
+  // register allocator
+  if (allocator.is_stack_allocator)
+    odb_context_allocators.push_back({odb_regions.size() - 1,
+                                      ContextAllocatorType::STACK_ALLOCATOR,
+                                      ptr});
+#endif
+  id = publishContext(index);
+  return OdResult::SUCCESS;
+}
+
+OdResult mem::carveContext(const char *name, std::size_t size_in_bytes, std::size_t align,
+                           ContextId parent, bool is_region, u32 &index) {
+  // check if mem was initialized first
+  if (!buffer_ || !size_)
+    return OdResult::BAD_ALLOCATION;
+  index = context_count_.load(std::memory_order_relaxed);
+  if (index == max_context_count)
+    return OdResult::OUT_OF_BOUNDS;
+  byte **marker = &next_;
+  byte *end = buffer_ + size_;
+  u32 depth = 0;
+  u64 hash = context_hash_seed;
+  if (parent.isValid()) {
+    if (!isAlive(parent))
+      return OdResult::INVALID_INPUT;
+    auto &parent_context = contexts_[parent.index];
+    if (!parent_context.is_region || parent_context.depth >= path_size_
+        || path_[parent_context.depth] != parent.index)
+      return OdResult::BAD_OPERATION;
+    marker = &parent_context.next;
+    end = parent_context.ptr + parent_context.size;
+    depth = parent_context.depth + 1;
+    hash = hashContextName(parent_context.path_hash, "/");
+  }
+  // check if there is room for the requested context size
+  byte *ptr = alignPointer(*marker, align);
+  if (ptr > end || static_cast<std::size_t>(end - ptr) < size_in_bytes)
+    return OdResult::OUT_OF_BOUNDS;
+  auto &context = contexts_[index];
+  context.size = size_in_bytes;
+  context.ptr = ptr;
+  context.carve_begin = *marker;
+  context.next = ptr;
+  context.parent = parent.index;
+  context.depth = depth;
+  context.is_region = is_region;
+  context.destroy = nullptr;
+  std::strncpy(context.name, name ? name : "", max_context_name_size - 1);
+  context.name[max_context_name_size - 1] = 0;
+  context.path_hash = hashContextName(hash, context.name);
+  ODYSSEUS_DEBUG_CODE(context.odb_region_count = odb_regions.size();)
+  *marker = ptr + size_in_bytes;
+  path_[depth] = index;
+  path_size_ = depth + 1;
+  return OdResult::SUCCESS;
+}
+
+void mem::destroyContexts(u32 first) {
+  for (u32 index = context_count_.load(std::memory_order_relaxed); index-- > first;) {
+    auto &context = contexts_[index];
+    if (context.destroy)
+      context.destroy(context.ptr);
+    context.destroy = nullptr;
+    // built-in contexts
+    if (reinterpret_cast<byte *>(general_purpose_) == context.ptr)
+      general_purpose_ = nullptr;
+    if (reinterpret_cast<byte *>(small_objects_) == context.ptr)
+      small_objects_ = nullptr;
+    if (frame_arenas_ == context.ptr) {
+      frame_arenas_ = nullptr;
+      frame_thread_count_ = 0;
+    }
+  }
+}
+
+mem::ContextId mem::publishContext(u32 index) {
+  auto &context = contexts_[index];
+  u32 generation = context.generation.load(std::memory_order_relaxed) + 1;
+  if (!generation)
+    generation = 1;
+  context.generation.store(generation, std::memory_order_release);
+  context_count_.store(index + 1, std::memory_order_release);
+  return {index, generation};
+}
+
+OdResult mem::pushGeneralPurposeContext(std::size_t size_in_bytes) {
+  auto &instance = get();
+  std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+  if (instance.general_purpose_)
+    return OdResult::BAD_OPERATION;
+  ContextId id{};
+  auto result = instance.createContext(nullptr, size_in_bytes, {},
+                                       contextAllocator<TlsfAllocator>(), 1, id);
+  if (result == OdResult::SUCCESS)
+    instance.general_purpose_ = reinterpret_cast<TlsfAllocator *>(instance.contexts_[id.index].ptr);
+  return result;
+}
+
+OdResult mem::pushSmallObjectContext(std::size_t size_in_bytes) {
+  auto &instance = get();
+  std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+  if (instance.small_objects_)
+    return OdResult::BAD_OPERATION;
+  ContextId id{};
+  auto result = instance.createContext(nullptr, size_in_bytes, {},
+                                       contextAllocator<SmallObjectAllocator>(), 1, id);
+  if (result == OdResult::SUCCESS)
+    instance.small_objects_ =
+        reinterpret_cast<SmallObjectAllocator *>(instance.contexts_[id.index].ptr);
+  return result;
+}
+
+void *mem::allocateBlock(std::size_t size_in_bytes, ContextType context, std::size_t align) {
+  auto &instance = get();
+  switch (context) {
+  case ContextType::SINGLE_FRAME: {
+    if (!instance.frame_arenas_ || threadIndex() >= instance.frame_thread_count_)
+      return nullptr;
+    auto &arena = frameArena();
+    auto handle = arena.allocate(size_in_bytes, align);
+    if (!handle.isValid())
+      return nullptr;
+    return arena.get<void>(handle);
+  }
+  case ContextType::SMALL_OBJECT:
+    if (instance.small_objects_ && align <= 16) {
+      void *ptr = instance.small_objects_->allocate(size_in_bytes);
+      if (ptr)
+        return ptr;
+    }
+    [[fallthrough]];
+  case ContextType::GENERAL_PURPOSE:
+    if (instance.general_purpose_)
+      return instance.general_purpose_->allocate(size_in_bytes, align);
+    [[fallthrough]];
+  case ContextType::HEAP:
+  default:
+    return allocAligned(size_in_bytes, align);
+  }
+}
+
+void mem::freeBlock(void *ptr) {
+  if (!ptr)
+    return;
+  auto &instance = get();
+  if (instance.small_objects_ && instance.small_objects_->owns(ptr))
+    instance.small_objects_->freeBlock(ptr);
+  else if (instance.general_purpose_ && instance.general_purpose_->owns(ptr))
+    instance.general_purpose_->freeBlock(ptr);
+  else if (ptr < instance.buffer_ || ptr >= instance.buffer_ + instance.size_)
+    freeAligned(ptr);
+}
+
+OdResult mem::pushFrameContext(std::size_t size_in_bytes, u32 thread_count) {
+  auto &instance = get();
+  // check if mem was initialized first
+  if (!instance.buffer_ || !instance.size_)
+    return OdResult::BAD_ALLOCATION;
+  std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+  if (instance.frame_arenas_ || !thread_count)
+    return OdResult::BAD_OPERATION;
+  if (size_in_bytes > StackAllocator::max_capacity)
+    return OdResult::OUT_OF_BOUNDS;
+  // each arena object sits in its own cache line, so threads bumping their
+  // markers don't share lines
+  const std::size_t stride = alignTo(sizeof(StackAllocator), cache_l1_size);
+  const std::size_t arena_count = 2 * thread_count;
+  u32 index = 0;
+  auto result = instance.carveContext(nullptr, arena_count * (stride + size_in_bytes),
+                                      cache_l1_size, {}, false, index);
+  if (result != OdResult::SUCCESS)
+    return result;
+  byte *arenas = instance.contexts_[index].ptr;
+  byte *data = arenas + arena_count * stride;
+  for (std::size_t i = 0; i < arena_count; ++i)
+    new(arenas + i * stride) StackAllocator(size_in_bytes, data + i * size_in_bytes);
+#ifdef ODYSSEUS_DEBUG
+  instance.odb_regions.push_back({
+                                     reinterpret_cast<uintptr_t>(arenas)
+                                         - reinterpret_cast<uintptr_t>(instance.buffer_),
+                                     stride,
+                                     arena_count,
+                                     ponos::ConsoleColors::color(instance.odb_regions.size() + 1),
+                                     StackAllocator::getRegions()
+                                 });
+  for (std::size_t i = 0; i < arena_count; ++i) {
+    instance.odb_regions.push_back({
+                                       reinterpret_cast<uintptr_t>(data + i * size_in_bytes)
+                                           - reinterpret_cast<uintptr_t>(instance.buffer_),
+                                       size_in_bytes,
+                                       1,
+                                       ponos::ConsoleColors::color(instance.odb_regions.size() + 1),
+                                       {}
+                                   });
+    instance.odb_context_allocators.push_back(
+        {instance.odb_regions.size() - 1,
+         ContextAllocatorType::STACK_ALLOCATOR,
+         arenas + i * stride});
+  }
+#endif
+  instance.contexts_[index].destroy = [](byte *ptr) {
+    auto &instance = get();
+    for (u32 i = 0; i < 2 * instance.frame_thread_count_; ++i)
+      reinterpret_cast<StackAllocator *>(ptr + i * instance.frame_arena_stride_)->~StackAllocator();
+  };
+  instance.frame_arenas_ = arenas;
+  instance.frame_arena_stride_ = stride;
+  instance.frame_thread_count_ = thread_count;
+  instance.frame_index_ = 0;
+  instance.publishContext(index);
+  return OdResult::SUCCESS;
+}
+
+void mem::beginFrame() {
+  auto &instance = get();
+  ASSERT(!instance.in_frame_)
+  instance.in_frame_ = true;
+  ++instance.frame_index_;
+  // arenas of this frame were last used by frame N - 2
+  for (u32 i = 0; i < instance.frame_thread_count_; ++i)
+    frameArena(i).clear();
+}
+
+void mem::endFrame() {
+  auto &instance = get();
+  ASSERT(instance.in_frame_)
+  instance.in_frame_ = false;
+}
+
+u64 mem::frameIndex() {
+  return get().frame_index_;
+}
+
+StackAllocator &mem::frameArena(u32 thread_index) {
+  auto &instance = get();
+  ASSERT(instance.frame_arenas_ && thread_index < instance.frame_thread_count_)
+  return *reinterpret_cast<StackAllocator *>(instance.frame_arenas_ +
+      (2 * thread_index + instance.frame_index_ % 2) * instance.frame_arena_stride_);
+}
+
+StackAllocator &mem::previousFrameArena(u32 thread_index) {
+  auto &instance = get();
+  ASSERT(instance.frame_arenas_ && thread_index < instance.frame_thread_count_)
+  return *reinterpret_cast<StackAllocator *>(instance.frame_arenas_ +
+      (2 * thread_index + (instance.frame_index_ + 1) % 2) * instance.frame_arena_stride_);
+}
+
+void mem::setThreadIndex(u32 thread_index) {
+  thread_index_ = thread_index;
+}
+
+u32 mem::threadIndex() {
+  return thread_index_;
+}
+
 #ifdef ODYSSEUS_DEBUG
 std::string mem::dump(std::size_t start, std::size_t size) {
   auto &instance = get();
@@ -31,7 +31,12 @@
 #include <ponos/common/defs.h>
 #include <odysseus/debug/debug.h>
 #include <odysseus/debug/result.h>
+#include <odysseus/memory/allocation_tracking.h>
+#include <cstddef>
+#include <atomic>
 #include <cstdint>
+#include <limits>
+#include <mutex>
 #include <vector>
 #ifdef ODYSSEUS_DEBUG
 #include <ponos/log/memory_dump.h>
@@ -39,11 +44,6 @@
 
 namespace odysseus {
 
-#ifdef ODYSSEUS_DEBUG
-class StackAllocator;
-class DoubleStackAllocator;
-#endif
-
 /// Object returned by all memory allocators
 /// Each allocator puts a meaning into its value
 struct MemHandle {
@@ -52,16 +52,81 @@ struct MemHandle {
   [[nodiscard]] inline bool isValid() const { return id != 0; }
 };
 
+/// Bit layout of handles built by stack allocators
+/// The lower OffsetBits bits of the handle id store the address offset + 1
+/// of the first byte of the allocated block, the next ShiftBits bits store
+/// the alignment shift applied to the block. The offset width limits the
+/// capacity of the allocator.
+/// \tparam OffsetBits
+/// \tparam ShiftBits
+template<u32 OffsetBits, u32 ShiftBits>
+struct MemHandleLayout {
+  static_assert(OffsetBits > 0 && ShiftBits > 0);
+  static_assert(OffsetBits + ShiftBits <= sizeof(std::size_t) * 8,
+                "handle layout does not fit in MemHandle::id");
+  static constexpr std::size_t offset_mask = (std::size_t(1) << OffsetBits) - 1;
+  /// maximum number of bytes an allocator can address with this layout
+  static constexpr std::size_t max_capacity = offset_mask;
+  /// maximum alignment shift the layout can store
+  static constexpr std::size_t max_shift = (std::size_t(1) << ShiftBits) - 1;
+  /// \param marker offset of the first byte of the block
+  /// \param shift alignment shift
+  /// \return handle id
+  static constexpr std::size_t build(std::size_t marker, std::size_t shift) {
+    return (marker + 1u) | (shift << OffsetBits);
+  }
+  /// \param id handle id
+  /// \return offset of the first byte of the block
+  static constexpr std::size_t extractMarker(std::size_t id) {
+    return (id & offset_mask) - 1;
+  }
+  /// \param id handle id
+  /// \return alignment shift of the block
+  static constexpr std::size_t extractShift(std::size_t id) {
+    return (id >> OffsetBits) & max_shift;
+  }
+};
+/// 32 bit handles, for allocators of up to 16 MB
+using SmallMemHandleLayout = MemHandleLayout<24, 8>;
+/// 64 bit handles, for allocators of up to 64 PB
+using WideMemHandleLayout = MemHandleLayout<56, 8>;
+
+template<class HandleLayout, class Tracking>
+class BasicStackAllocator;
+using StackAllocator = BasicStackAllocator<SmallMemHandleLayout, DefaultTracking>;
+class TlsfAllocator;
+class SmallObjectAllocator;
+#ifdef ODYSSEUS_DEBUG
+template<class HandleLayout, class Tracking>
+class BasicDoubleStackAllocator;
+using DoubleStackAllocator = BasicDoubleStackAllocator<SmallMemHandleLayout, DefaultTracking>;
+#endif
+
 /// Memory Manager Singleton
 /// This class is responsible for managing all memory used in the system by
 /// allocating all memory first and controlling how the allocated memory is
 /// used.
 class mem {
 public:
-  ///
+  /// \note Only HEAP is thread-safe. SINGLE_FRAME arenas belong to a single
+  /// thread each, GENERAL_PURPOSE and SMALL_OBJECT are unsynchronized and
+  /// must be used by one thread at a time (not from concurrent jobs).
   enum class ContextType {
-    HEAP,
-    SINGLE_FRAME [[maybe_unused]],
+    HEAP,            //!< system heap, through allocAligned
+    SINGLE_FRAME,    //!< frame arena of the calling thread
+    GENERAL_PURPOSE, //!< TLSF allocator carved from the mem buffer (single thread)
+    SMALL_OBJECT,    //!< size class allocator for blocks up to 512 bytes (single thread)
+  };
+  /// Controls how the mem buffer is allocated
+  struct InitOptions {
+    /// map the buffer as anonymous virtual memory (mmap) instead of new[]
+    bool use_virtual_memory;
+    /// request huge pages for the mapping (MAP_HUGETLB when available,
+    /// MADV_HUGEPAGE otherwise)
+    bool huge_pages;
+    /// number of threads touching every page of the buffer during init, so
+    /// page faults don't happen during the first frames (0 disables it)
+    u32 prefault_thread_count;
   };
   /****************************************************************************
                                STATIC PUBLIC FIELDS
@@ -115,6 +180,14 @@ public:
     const uintptr_t addr_aligned = alignAddress(addr, align);
     return reinterpret_cast<T *>(addr_aligned);
   }
+  /// \param n
+  /// \return smallest power of two greater or equal to n
+  static inline std::size_t nextPowerOfTwo(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n)
+      p <<= 1u;
+    return p;
+  }
   /// Allocates **size** bytes of memory aligned by **align** bytes.
   /// \param size **[in]** memory size in bytes
   /// \param align **[in]** number of bytes of alignment
@@ -136,11 +209,43 @@ public:
                                 METHODS
   ****************************************************************************/
   /// Allocates the memory that will be available for all allocators to use
+  /// \note Calling init again releases the previous buffer and all of its
+  /// \note contexts.
   /// \param size_in_bytes
   /// \return
   static OdResult init(std::size_t size_in_bytes);
+  /// \note Virtual memory and huge pages are only available on POSIX
+  /// \note systems, other systems fall back to new[].
+  /// \param size_in_bytes
+  /// \param options
+  /// \return
+  static OdResult init(std::size_t size_in_bytes, const InitOptions &options);
+  /// \return true if the buffer was mapped with huge pages (MAP_HUGETLB)
+  static bool usingHugePages();
 
   static std::size_t availableSize();
+  /****************************************************************************
+                                CONTEXTS
+  ****************************************************************************/
+  // Contexts form a hierarchy (engine -> level -> subsystem). Each context
+  // is carved from the memory of its parent (the mem buffer for top level
+  // contexts) and contexts are created and released in stack order:
+  // children can only be added to the most recent context of each level,
+  // and releasing a context releases, in O(1), every context created after
+  // it, which are all its descendants.
+  // Creation, release and lookup of contexts are thread-safe.
+  /// Identifies a context. A value with a generation of zero is invalid,
+  /// stale ids (of released contexts) are detected by the generation of
+  /// their slot.
+  struct ContextId {
+    u32 index;
+    u32 generation;
+    [[nodiscard]] inline bool isValid() const { return generation != 0; }
+  };
+  /// maximum number of live contexts
+  static constexpr u32 max_context_count = 256;
+  /// maximum size of a context name, including the terminator
+  static constexpr std::size_t max_context_name_size = 32;
   ///
   /// \tparam AllocatorType
   /// \param size_in_bytes
@@ -149,49 +254,132 @@ public:
   template<typename AllocatorType>
   static OdResult pushContext(std::size_t size_in_bytes) {
     auto &instance = get();
-    // check if mem was initialized first
-    if (!instance.buffer_ || !instance.size_)
-      return OdResult::BAD_ALLOCATION;
-    // check if there is room for the requested context size
-    if (availableSize() < size_in_bytes + sizeof(AllocatorType))
-      return OdResult::OUT_OF_BOUNDS;
-    instance.contexts_.push_back({size_in_bytes + sizeof(AllocatorType), instance.next_});
-    new(instance.next_) AllocatorType(size_in_bytes,
-                                      instance.next_ + sizeof(AllocatorType));
-#ifdef ODYSSEUS_DEBUG
-    instance.odb_regions.push_back({
-                                       reinterpret_cast<uintptr_t>(instance.next_)
-                                           - reinterpret_cast<uintptr_t>(instance.buffer_),
-                                       sizeof(AllocatorType),
-                                       1,
-                                       ponos::ConsoleColors::color(instance.odb_regions.size() + 1),
-                                       AllocatorType::getRegions()
-                                   });
-    instance.odb_regions.push_back({
-                                       reinterpret_cast<uintptr_t>(instance.next_)
-                                           - reinterpret_cast<uintptr_t>(instance.buffer_)
-                                           + sizeof(AllocatorType),
-                                       size_in_bytes,
-                                       1,
-                                       ponos::ConsoleColors::color(instance.odb_regions.size() + 1),
-                                       {}
-                                   });
-    // register allocator
-    if (std::is_same_v<AllocatorType, StackAllocator>)
-      instance.odb_context_allocators.push_back(
-          {instance.odb_regions.size() - 1,
-           ContextAllocatorType::STACK_ALLOCATOR,
-           instance.next_});
-#endif
-    instance.next_ += sizeof(AllocatorType) + size_in_bytes;
-    return OdResult::SUCCESS;
+    std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+    ContextId id{};
+    return instance.createContext(nullptr, size_in_bytes, {},
+                                  contextAllocator<AllocatorType>(), 1, id);
   }
+  /// Creates a named context holding an AllocatorType of size_in_bytes.
+  /// \note Allocator contexts can't have children.
+  /// \tparam AllocatorType
+  /// \param name context name, unique among its siblings
+  /// \param size_in_bytes capacity of the allocator
+  /// \param parent region the context is carved from (invalid for the mem
+  /// buffer)
+  /// \return id of the context, invalid on failure (also when size_in_bytes
+  /// exceeds AllocatorType::max_capacity)
+  template<typename AllocatorType>
+  static ContextId pushContext(const char *name, std::size_t size_in_bytes,
+                               ContextId parent = {}) {
+    auto &instance = get();
+    std::lock_guard<std::mutex> guard(instance.contexts_mutex_);
+    ContextId id{};
+    instance.createContext(name, size_in_bytes, parent,
+                           contextAllocator<AllocatorType>(), alignof(std::max_align_t), id);
+    return id;
+  }
+  /// Creates a named region, a context with no allocator whose memory is
+  /// carved by its children.
+  /// \param name region name, unique among its siblings
+  /// \param size_in_bytes
+  /// \param parent region the context is carved from (invalid for the mem
+  /// buffer)
+  /// \return id of the region, invalid on failure
+  static ContextId pushRegion(const char *name, std::size_t size_in_bytes,
+                              ContextId parent = {});
+  /// Destroys the allocators of the context and all its descendants
+  /// (youngest first) and releases their memory.
+  /// \param id
+  /// \return BAD_OPERATION if contexts other than its descendants were
+  /// created after it
+  static OdResult popContext(ContextId id);
+  /// Finds a context by its path, the names from the top level context
+  /// joined by '/' (ex: "engine/level/physics"). Results are cached per
+  /// thread, repeated lookups don't lock.
+  /// \param path
+  /// \return id of the context, invalid if not found
+  static ContextId findContext(const char *path);
+  /// \param id
+  /// \return true if id refers to a live context
+  static bool isAlive(ContextId id);
+  /// \param region
+  /// \return number of bytes still available for children of region
+  static std::size_t availableSize(ContextId region);
 
   template<class AllocatorType>
   static AllocatorType &getContext(u32 context_index) {
     auto &instance = get();
     return *reinterpret_cast<AllocatorType *>(instance.contexts_[context_index].ptr);
   }
+  /// \tparam AllocatorType
+  /// \param id
+  /// \return allocator of the context, nullptr if id is not alive
+  template<class AllocatorType>
+  static AllocatorType *getContext(ContextId id) {
+    if (!isAlive(id))
+      return nullptr;
+    return reinterpret_cast<AllocatorType *>(get().contexts_[id.index].ptr);
+  }
+  /****************************************************************************
+                                 BLOCKS
+  ****************************************************************************/
+  /// Creates the GENERAL_PURPOSE context, a TlsfAllocator of size_in_bytes.
+  /// \note The general purpose context can be pushed only once per init.
+  /// \param size_in_bytes
+  /// \return
+  static OdResult pushGeneralPurposeContext(std::size_t size_in_bytes);
+  /// Creates the SMALL_OBJECT context, a SmallObjectAllocator of size_in_bytes.
+  /// \note The small object context can be pushed only once per init.
+  /// \param size_in_bytes
+  /// \return
+  static OdResult pushSmallObjectContext(std::size_t size_in_bytes);
+  /// Allocates a block of memory from the given context.
+  /// \note GENERAL_PURPOSE falls back to HEAP while no general purpose
+  /// \note context exists.
+  /// \note SMALL_OBJECT falls back to GENERAL_PURPOSE for blocks it can't
+  /// \note serve (too large, aligned beyond 16 bytes, or out of slabs).
+  /// \param size_in_bytes
+  /// \param context
+  /// \param align power of two alignment
+  /// \return pointer to the block, nullptr on failure
+  static void *allocateBlock(std::size_t size_in_bytes,
+                             ContextType context = ContextType::GENERAL_PURPOSE,
+                             std::size_t align = alignof(std::max_align_t));
+  /// Frees a block returned by allocateBlock. The owner context is deduced
+  /// from the address. SINGLE_FRAME blocks are ignored, they are released
+  /// with their frame.
+  /// \param ptr
+  static void freeBlock(void *ptr);
+  /****************************************************************************
+                                 FRAME
+  ****************************************************************************/
+  /// Creates the SINGLE_FRAME context. Each thread gets two stack allocators
+  /// (frame arenas) of size_in_bytes that alternate between frames: frame N
+  /// allocates from arena N % 2, so data of frame N - 1 stays readable while
+  /// frame N is built. An arena is cleared when frame N + 2 begins.
+  /// \note The frame context can be pushed only once per init.
+  /// \param size_in_bytes capacity of each frame arena
+  /// \param thread_count number of threads allowed to use frame arenas
+  /// \return OUT_OF_BOUNDS if size_in_bytes exceeds StackAllocator::max_capacity
+  /// or doesn't fit the mem buffer
+  static OdResult pushFrameContext(std::size_t size_in_bytes, u32 thread_count = 1);
+  /// Starts a new frame, clearing (in O(1)) the arenas used two frames ago.
+  static void beginFrame();
+  /// Closes the current frame
+  static void endFrame();
+  /// \return current frame index
+  static u64 frameIndex();
+  /// \param thread_index
+  /// \return frame arena used by thread_index in the current frame
+  static StackAllocator &frameArena(u32 thread_index = threadIndex());
+  /// \param thread_index
+  /// \return frame arena used by thread_index in the previous frame
+  static StackAllocator &previousFrameArena(u32 thread_index = threadIndex());
+  /// Sets the index of the calling thread, used to select its frame arena.
+  /// \param thread_index
+  static void setThreadIndex(u32 thread_index);
+  /// \return the index of the calling thread (defaults to 0)
+  static u32 threadIndex();
 
 /****************************************************************************
                               DEBUG
@@ -215,16 +403,109 @@ public:
 private:
   mem() = default;
   ~mem();
+  /// Releases the buffer, either mapped or allocated with new[]
+  void releaseBuffer();
+
+  /// Describes how to place an allocator in a context
+  struct ContextAllocator {
+    std::size_t object_size;
+    void (*construct)(byte *ptr, std::size_t size_in_bytes);
+    void (*destroy)(byte *ptr);
+    /// largest size the allocator can address
+    std::size_t max_size;
+#ifdef ODYSSEUS_DEBUG
+    std::vector<ponos::MemoryDumper::Region> (*regions)();
+    bool is_stack_allocator;
+#endif
+  };
+  /// \return AllocatorType::max_capacity, if the allocator defines it
+  template<typename AllocatorType>
+  static constexpr auto maxCapacity(int) -> decltype(std::size_t(AllocatorType::max_capacity)) {
+    return AllocatorType::max_capacity;
+  }
+  template<typename AllocatorType>
+  static constexpr std::size_t maxCapacity(long) {
+    return std::numeric_limits<std::size_t>::max();
+  }
+  template<typename AllocatorType>
+  static ContextAllocator contextAllocator() {
+    return {sizeof(AllocatorType),
+            [](byte *ptr, std::size_t size_in_bytes) {
+              new(ptr) AllocatorType(size_in_bytes, ptr + sizeof(AllocatorType));
+            },
+            [](byte *ptr) {
+              reinterpret_cast<AllocatorType *>(ptr)->~AllocatorType();
+            },
+            maxCapacity<AllocatorType>(0)
+#ifdef ODYSSEUS_DEBUG
+        , &AllocatorType::getRegions,
+            std::is_same_v<AllocatorType, StackAllocator>
+#endif
+    };
+  }
+  /// Carves, constructs and publishes a context (contexts_mutex_ held)
+  OdResult createContext(const char *name, std::size_t size_in_bytes, ContextId parent,
+                         const ContextAllocator &allocator, std::size_t align, ContextId &id);
+  /// Reserves the next context slot (contexts_mutex_ held)
+  OdResult carveContext(const char *name, std::size_t size_in_bytes, std::size_t align,
+                        ContextId parent, bool is_region, u32 &index);
+  /// Makes the context at index visible to lookups (contexts_mutex_ held)
+  ContextId publishContext(u32 index);
+  /// Destroys the allocators of the contexts from first on, youngest first
+  /// (contexts_mutex_ held)
+  void destroyContexts(u32 first);
 
   struct ContextInfo {
-    std::size_t size;
-    byte *ptr;
+    std::size_t size{0};
+    byte *ptr{nullptr};
+    // parent marker before this context was carved (includes padding)
+    byte *carve_begin{nullptr};
+    // marker of children (regions only)
+    byte *next{nullptr};
+    u64 path_hash{0};
+    u32 parent{0};
+    u32 depth{0};
+    bool is_region{false};
+    /// destroys the allocator placed at ptr (null for regions)
+    void (*destroy)(byte *ptr){nullptr};
+    char name[max_context_name_size]{};
+    std::atomic<u32> generation{0};
+#ifdef ODYSSEUS_DEBUG
+    // debug regions registered before this context
+    std::size_t odb_region_count{0};
+#endif
+  };
+  struct ContextCacheEntry {
+    u64 hash{0};
+    ContextId id{};
   };
+  static constexpr u32 context_cache_size = 16;
 
-  std::vector<ContextInfo> contexts_;
+  std::mutex contexts_mutex_;
+  ContextInfo contexts_[max_context_count];
+  std::atomic<u32> context_count_{0};
+  // most recent context of each level, the only ones accepting children
+  u32 path_[max_context_count]{};
+  u32 path_size_{0};
+  static thread_local ContextCacheEntry context_cache_[context_cache_size];
   std::size_t size_{0};
   byte *buffer_{nullptr};
   byte *next_{nullptr};
+  // virtual memory mapping backing buffer_ (if any)
+  void *mapping_{nullptr};
+  std::size_t mapping_size_{0};
+  bool huge_pages_{false};
+  // general purpose context
+  TlsfAllocator *general_purpose_{nullptr};
+  // small object context
+  SmallObjectAllocator *small_objects_{nullptr};
+  // frame context
+  byte *frame_arenas_{nullptr};
+  std::size_t frame_arena_stride_{0};
+  u32 frame_thread_count_{0};
+  u64 frame_index_{0};
+  bool in_frame_{false};
+  static thread_local u32 thread_index_;
 
 };
 
@@ -0,0 +1,77 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file memory_resource.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/memory/memory_resource.h>
+
+namespace odysseus {
+
+PoolMemoryResource::PoolMemoryResource(PoolAllocator &allocator, std::pmr::memory_resource *upstream)
+    : allocator_{allocator}, upstream_{upstream} {}
+
+void *PoolMemoryResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+  // pool objects are aligned to the largest power of two dividing the object
+  // size, up to the alignment of the pool memory
+  if (bytes <= allocator_.objectSizeInBytes() && alignment <= alignof(std::max_align_t)
+      && allocator_.objectSizeInBytes() % alignment == 0) {
+    auto *ptr = allocator_.allocate();
+    if (ptr)
+      return ptr;
+  }
+  return upstream_->allocate(bytes, alignment);
+}
+
+void PoolMemoryResource::do_deallocate(void *p, std::size_t bytes, std::size_t alignment) {
+  if (allocator_.owns(p))
+    allocator_.freeObject(p);
+  else
+    upstream_->deallocate(p, bytes, alignment);
+}
+
+bool PoolMemoryResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+  return this == &other;
+}
+
+MemContextResource::MemContextResource(mem::ContextType context) : context_{context} {}
+
+void *MemContextResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+  auto *ptr = mem::allocateBlock(bytes, context_, alignment);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void MemContextResource::do_deallocate(void *p, std::size_t, std::size_t) {
+  mem::freeBlock(p);
+}
+
+bool MemContextResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+  // all resources of the same context share the same memory
+  auto *other_context = dynamic_cast<const MemContextResource *>(&other);
+  return other_context && other_context->context_ == context_;
+}
+
+}
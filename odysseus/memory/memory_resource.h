@@ -0,0 +1,212 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file memory_resource.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_MEMORY_MEMORY_RESOURCE_H
+#define ODYSSEUS_ODYSSEUS_MEMORY_MEMORY_RESOURCE_H
+
+#include <odysseus/memory/double_stack_allocator.h>
+#include <odysseus/memory/pool_allocator.h>
+#include <odysseus/memory/stack_allocator.h>
+#include <limits>
+#include <memory_resource>
+#include <new>
+
+namespace odysseus {
+
+/// std::pmr adapter of a stack allocator
+/// Blocks are released all at once, through the stack allocator (freeTo or
+/// clear), so deallocate does nothing for blocks owned by the stack. When
+/// the stack is full, requests go to the upstream resource (which throws
+/// std::bad_alloc by default).
+/// \note The stack must outlive the containers using the resource.
+/// \tparam StackAllocatorType a BasicStackAllocator
+template<class StackAllocatorType>
+class StackMemoryResource final : public std::pmr::memory_resource {
+public:
+  /// \param allocator
+  /// \param upstream resource used when the stack is full
+  explicit StackMemoryResource(StackAllocatorType &allocator,
+                               std::pmr::memory_resource *upstream = std::pmr::null_memory_resource())
+      : allocator_{allocator}, upstream_{upstream} {}
+  /// \return underlying stack allocator
+  StackAllocatorType &allocator() const { return allocator_; }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    auto handle = allocator_.allocate(bytes, alignment);
+    if (handle.isValid())
+      return allocator_.template get<void>(handle);
+    return upstream_->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+    if (!allocator_.owns(p))
+      upstream_->deallocate(p, bytes, alignment);
+  }
+  [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  StackAllocatorType &allocator_;
+  std::pmr::memory_resource *upstream_;
+};
+
+/// std::pmr adapter of one of the stacks of a double stack allocator
+/// Behaves as StackMemoryResource, two resources (one per side) can share the
+/// same double stack allocator.
+/// \tparam DoubleStackAllocatorType a BasicDoubleStackAllocator
+template<class DoubleStackAllocatorType>
+class DoubleStackMemoryResource final : public std::pmr::memory_resource {
+public:
+  enum class Side {
+    LOWER,
+    UPPER
+  };
+  /// \param allocator
+  /// \param side stack used by this resource
+  /// \param upstream resource used when the stack is full
+  DoubleStackMemoryResource(DoubleStackAllocatorType &allocator, Side side,
+                            std::pmr::memory_resource *upstream = std::pmr::null_memory_resource())
+      : allocator_{allocator}, side_{side}, upstream_{upstream} {}
+  /// \return underlying double stack allocator
+  DoubleStackAllocatorType &allocator() const { return allocator_; }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    auto handle = side_ == Side::LOWER ? allocator_.allocateLower(bytes, alignment)
+                                       : allocator_.allocateUpper(bytes, alignment);
+    if (handle.isValid())
+      return allocator_.template get<void>(handle);
+    return upstream_->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+    if (!allocator_.owns(p))
+      upstream_->deallocate(p, bytes, alignment);
+  }
+  [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  DoubleStackAllocatorType &allocator_;
+  Side side_;
+  std::pmr::memory_resource *upstream_;
+};
+
+/// std::pmr adapter of a pool allocator
+/// Serves requests that fit in a pool object (node based containers, like
+/// std::pmr::list, std::pmr::map or the nodes of std::pmr::unordered_map).
+/// Larger or over-aligned requests, and requests made while the pool is
+/// full, go to the upstream resource.
+class PoolMemoryResource final : public std::pmr::memory_resource {
+public:
+  /// \param allocator
+  /// \param upstream resource used for requests the pool can't serve
+  explicit PoolMemoryResource(PoolAllocator &allocator,
+                              std::pmr::memory_resource *upstream = std::pmr::null_memory_resource());
+  /// \return underlying pool allocator
+  PoolAllocator &allocator() const { return allocator_; }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override;
+  [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+private:
+  PoolAllocator &allocator_;
+  std::pmr::memory_resource *upstream_;
+};
+
+/// std::pmr adapter of a mem context
+/// Forwards requests to mem::allocateBlock / mem::freeBlock. Blocks of the
+/// SINGLE_FRAME context are released when the frame arena is recycled
+/// (see mem::beginFrame).
+/// \note Throws std::bad_alloc when the context can't serve a request, as
+/// required by std::pmr::memory_resource.
+class MemContextResource final : public std::pmr::memory_resource {
+public:
+  /// \param context
+  explicit MemContextResource(mem::ContextType context = mem::ContextType::GENERAL_PURPOSE);
+  /// \return
+  [[nodiscard]] mem::ContextType context() const { return context_; }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override;
+  [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+private:
+  mem::ContextType context_;
+};
+
+/// STL allocator bound to a memory resource
+/// Unlike std::pmr::polymorphic_allocator, the resource type is part of the
+/// allocator type, so calls into the (final) resource classes above are
+/// resolved at compile time.
+/// \tparam T
+/// \tparam Resource a std::pmr::memory_resource
+template<typename T, class Resource>
+class StlAllocator {
+public:
+  using value_type = T;
+  /// \param resource
+  explicit StlAllocator(Resource &resource) noexcept: resource_{&resource} {}
+  template<typename U>
+  StlAllocator(const StlAllocator<U, Resource> &other) noexcept : resource_{other.resource()} {}
+  ///
+  /// \param n
+  /// \return
+  T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+  ///
+  /// \param p
+  /// \param n
+  void deallocate(T *p, std::size_t n) noexcept {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+  /// \return
+  [[nodiscard]] Resource *resource() const noexcept { return resource_; }
+
+  template<typename U>
+  friend bool operator==(const StlAllocator &a, const StlAllocator<U, Resource> &b) noexcept {
+    return a.resource() == b.resource();
+  }
+  template<typename U>
+  friend bool operator!=(const StlAllocator &a, const StlAllocator<U, Resource> &b) noexcept {
+    return a.resource() != b.resource();
+  }
+
+private:
+  Resource *resource_;
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_MEMORY_MEMORY_RESOURCE_H
@@ -26,8 +26,25 @@
 ///\brief
 
 #include <odysseus/memory/pool_allocator.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 
 namespace odysseus {
+
+// free objects store the index of the next free object in their first bytes.
+// Object sizes need not be multiples of sizeof(u32), so links may be
+// misaligned and are copied byte-wise
+static inline u32 loadLink(const void *object) {
+  u32 next;
+  std::memcpy(&next, object, sizeof(u32));
+  return next;
+}
+
+static inline void storeLink(void *object, u32 next) {
+  std::memcpy(object, &next, sizeof(u32));
+}
+
 /******************************************************************************
  *                                 DEBUG
 ******************************************************************************/
@@ -37,31 +54,49 @@ namespace odysseus {
 /// \param object_count
 /// \param object_size_in_bytes
 void dumpAvailableList(void *ptr, u32 head, u32 object_count, u32 object_size_in_bytes) {
-  auto *p = reinterpret_cast<u32 *>(reinterpret_cast<u8 *>(ptr) + head * object_size_in_bytes);
-  auto *end = reinterpret_cast<u32 *>(reinterpret_cast<u8 *>(ptr) + object_count * object_size_in_bytes);
+  auto *p = reinterpret_cast<u8 *>(ptr) + head * object_size_in_bytes;
+  auto *end = reinterpret_cast<u8 *>(ptr) + object_count * object_size_in_bytes;
   int i = 0;
   while (p < end) {
-    printf("free object %d: next %u address %p < sentinel %p\n", i, *p, (void *) p, (void *) end);
-    p = reinterpret_cast<u32 *> (reinterpret_cast<u8 *>(ptr) + (*p) * object_size_in_bytes);
+    printf("free object %d: next %u address %p < sentinel %p\n", i, loadLink(p), (void *) p, (void *) end);
+    p = reinterpret_cast<u8 *>(ptr) + loadLink(p) * object_size_in_bytes;
     if (i++ > 12)
       break;
   }
 }
 
-PoolAllocator::PoolAllocator(u32 object_size_in_bytes, u32 object_count, mem::ContextType context)
-    : capacity_{object_count}, object_size_in_bytes_{object_size_in_bytes} {
+// slab header, padded to keep objects aligned
+struct SlabHeader {
+  u32 index;
+};
+static constexpr std::size_t slab_header_size = alignof(std::max_align_t);
+static_assert(sizeof(SlabHeader) <= slab_header_size);
+
+PoolAllocator::PoolAllocator(u32 object_size_in_bytes, u32 object_count, mem::ContextType context, Mode mode)
+    : object_size_in_bytes_{object_size_in_bytes}, context_{context} {
   ASSERT(object_size_in_bytes >= sizeof(u32));
-//  data_ = mem::allocateBlock(object_size_in_bytes * object_count, context);
-  // create linked list for free objects
-  auto *p = reinterpret_cast<u32 *>(data_);
-  for (uintptr_t i = 0; i < object_count; i++) {
-    *p = i + 1;
-    p = reinterpret_cast<u32 *> (reinterpret_cast<u8 *>(data_) + (i + 1) * object_size_in_bytes);
+  if (mode == Mode::GROWABLE) {
+    // slabs are aligned to their own size so the owner of any object can be
+    // found by masking its address
+    slab_size_ = mem::nextPowerOfTwo(slab_header_size +
+        static_cast<std::size_t>(object_size_in_bytes) * object_count);
+    objects_per_slab_ = static_cast<u32>((slab_size_ - slab_header_size) / object_size_in_bytes);
+    return;
   }
+  // neither objects nor generations are touched here, slots are
+  // initialized by the bump allocation
+  data_ = mem::allocateBlock(static_cast<std::size_t>(object_size_in_bytes) * object_count, context);
+  generations_ = reinterpret_cast<u32 *>(mem::allocateBlock(sizeof(u32) * object_count, context));
+  if (!data_ || !generations_)
+    return;
+  capacity_ = object_count;
 }
 
 PoolAllocator::~PoolAllocator() {
-//  mem::freeBlock(data_);
+  for (auto *slab : slabs_)
+    mem::freeBlock(slab);
+  mem::freeBlock(data_);
+  mem::freeBlock(generations_);
 }
 
 u32 PoolAllocator::capacityInBytes() const {
@@ -80,24 +115,191 @@ u32 PoolAllocator::objectSizeInBytes() const {
   return object_size_in_bytes_;
 }
 
+u32 PoolAllocator::slabCount() const {
+  return slab_size_ ? slabs_.size() : 1;
+}
+
+std::size_t PoolAllocator::slabSizeInBytes() const {
+  return slab_size_;
+}
+
+bool PoolAllocator::owns(const void *ptr) const {
+  const auto *address = reinterpret_cast<const u8 *>(ptr);
+  if (!slab_size_)
+    return address >= reinterpret_cast<const u8 *>(data_) &&
+        address < reinterpret_cast<const u8 *>(data_) + capacityInBytes();
+  for (auto *slab : slabs_)
+    if (address >= slab + slab_header_size && address < slab + slab_size_)
+      return true;
+  return false;
+}
+
 void *PoolAllocator::allocate() {
-  if (head_ >= capacity_)
+  const u32 index = allocateIndex();
+  if (index >= capacity_)
     return nullptr;
-  size_++;
-  // get head pointer
-  auto *p = reinterpret_cast<u8 *>(data_) + head_ * object_size_in_bytes_;
-  // move head
-  head_ = *reinterpret_cast<u32 *>(p);
-  return reinterpret_cast<void *>(p);
+  return objectAddress(index);
 }
 
 void PoolAllocator::freeObject(void *ptr) {
+  freeIndex(objectIndex(ptr));
+}
+
+void PoolAllocator::reset() {
+  head_ = null_index;
+  bump_ = 0;
+  size_ = 0;
+}
+
+u32 PoolAllocator::allocateBatch(u32 n, void **out_ptrs) {
+  u32 count = 0;
+  // recycled slots first
+  while (count < n && head_ != null_index) {
+    // walk a run of consecutive slots, which share a slab
+    u32 index = head_;
+    auto *ptr = objectAddress(index);
+    const u32 run_end = slab_size_ ? (index / objects_per_slab_ + 1) * objects_per_slab_ : capacity_;
+    while (count < n) {
+      out_ptrs[count++] = ptr;
+      generations_[index]++;
+      head_ = loadLink(ptr);
+      if (head_ != index + 1 || head_ >= run_end)
+        break;
+      index = head_;
+      ptr += object_size_in_bytes_;
+    }
+  }
+  // then never used slots, consecutive up to the end of their slab
+  while (count < n) {
+    if (bump_ >= capacity_ && (!slab_size_ || !addSlab()))
+      break;
+    const u32 run_end = slab_size_ ? (bump_ / objects_per_slab_ + 1) * objects_per_slab_ : capacity_;
+    const u32 run = std::min(n - count, run_end - bump_);
+    auto *ptr = objectAddress(bump_);
+    for (u32 i = 0; i < run; ++i, ptr += object_size_in_bytes_) {
+      out_ptrs[count++] = ptr;
+      generations_[bump_ + i] = nextAliveGeneration(generations_[bump_ + i]);
+    }
+    bump_ += run;
+  }
+  size_ += count;
+  return count;
+}
+
+void PoolAllocator::freeBatch(void *const *ptrs, u32 n) {
+  if (!n)
+    return;
+  ASSERT(size_ >= n);
+  const u32 first = objectIndex(ptrs[0]);
+  u32 index = first;
+  for (u32 i = 1; i < n; ++i) {
+    // consecutive objects skip the address to index division
+    const u32 next = reinterpret_cast<u8 *>(ptrs[i]) == reinterpret_cast<u8 *>(ptrs[i - 1]) + object_size_in_bytes_
+                     && (!slab_size_ || (index + 1) % objects_per_slab_) ? index + 1 : objectIndex(ptrs[i]);
+    ASSERT(generations_[index] & 1u)
+    generations_[index]++;
+    storeLink(ptrs[i - 1], next);
+    index = next;
+  }
+  ASSERT(generations_[index] & 1u)
+  generations_[index]++;
+  storeLink(ptrs[n - 1], head_);
+  head_ = first;
+  size_ -= n;
+}
+
+PoolAllocator::Handle PoolAllocator::allocateHandle() {
+  const u32 index = allocateIndex();
+  if (index >= capacity_)
+    return {};
+  return {index, generations_[index]};
+}
+
+OdResult PoolAllocator::freeHandle(Handle handle) {
+  if (!isAlive(handle))
+    return OdResult::INVALID_INPUT;
+  freeIndex(handle.index);
+  return OdResult::SUCCESS;
+}
+
+void *PoolAllocator::get(Handle handle) const {
+  if (!isAlive(handle))
+    return nullptr;
+  return objectAddress(handle.index);
+}
+
+PoolAllocator::Handle PoolAllocator::handleOf(const void *ptr) const {
+  const u32 index = objectIndex(ptr);
+  ASSERT(generations_[index] & 1u)
+  return {index, generations_[index]};
+}
+
+u32 PoolAllocator::allocateIndex() {
+  u32 index;
+  if (head_ != null_index) {
+    index = head_;
+    // move head
+    head_ = loadLink(objectAddress(index));
+    generations_[index]++;
+  } else if (bump_ < capacity_ || (slab_size_ && addSlab())) {
+    index = bump_++;
+    generations_[index] = nextAliveGeneration(generations_[index]);
+  } else
+    return capacity_;
+  size_++;
+  return index;
+}
+
+void PoolAllocator::freeIndex(u32 index) {
   ASSERT(size_);
-  ptrdiff_t d = reinterpret_cast<u8 *>(ptr) - reinterpret_cast<u8 *>(data_);
-  auto *p = reinterpret_cast<u32 *>(reinterpret_cast<u8 *>(data_) + d);
-  *p = head_;
-  head_ = d / object_size_in_bytes_;
+  ASSERT(generations_[index] & 1u)
+  storeLink(objectAddress(index), head_);
+  head_ = index;
+  generations_[index]++;
   size_--;
 }
 
+bool PoolAllocator::addSlab() {
+  // indices must fit in the u32 free list links
+  if (static_cast<u64>(capacity_) + objects_per_slab_ >= 0xffffffffu)
+    return false;
+  // generations are kept in a single array, grown geometrically
+  if (capacity_ + objects_per_slab_ > generations_capacity_) {
+    const u32 new_capacity = static_cast<u32>(std::min<u64>(
+        std::max<u64>(2ull * generations_capacity_, capacity_ + objects_per_slab_), 0xffffffffu));
+    auto *generations = reinterpret_cast<u32 *>(mem::allocateBlock(sizeof(u32) * new_capacity, context_));
+    if (!generations)
+      return false;
+    if (generations_)
+      std::memcpy(generations, generations_, sizeof(u32) * capacity_);
+    mem::freeBlock(generations_);
+    generations_ = generations;
+    generations_capacity_ = new_capacity;
+  }
+  auto *slab = reinterpret_cast<u8 *>(mem::allocateBlock(slab_size_, context_, slab_size_));
+  if (!slab)
+    return false;
+  reinterpret_cast<SlabHeader *>(slab)->index = static_cast<u32>(slabs_.size());
+  slabs_.emplace_back(slab);
+  // new slots are handed out by the bump index
+  capacity_ += objects_per_slab_;
+  return true;
+}
+
+u8 *PoolAllocator::objectAddress(u32 index) const {
+  if (!slab_size_)
+    return reinterpret_cast<u8 *>(data_) + static_cast<std::size_t>(index) * object_size_in_bytes_;
+  return slabs_[index / objects_per_slab_] + slab_header_size +
+      static_cast<std::size_t>(index % objects_per_slab_) * object_size_in_bytes_;
+}
+
+u32 PoolAllocator::objectIndex(const void *ptr) const {
+  const auto address = reinterpret_cast<uintptr_t>(ptr);
+  if (!slab_size_)
+    return (address - reinterpret_cast<uintptr_t>(data_)) / object_size_in_bytes_;
+  const uintptr_t slab = address & ~(slab_size_ - 1);
+  return reinterpret_cast<const SlabHeader *>(slab)->index * objects_per_slab_ +
+      (address - slab - slab_header_size) / object_size_in_bytes_;
+}
+
 }
@@ -34,19 +34,58 @@ namespace odysseus {
 
 /// RAII Pool Allocator
 /// Stores a pool of objects of same size and allows arbitrary destruction order.
+///
+/// \note Growable Pools:
+/// \note A GROWABLE pool allocates its memory in slabs, on demand. Each slab
+/// is a power of two number of bytes, aligned to its own size, and starts
+/// with a small header holding the slab index. Object indices run across all
+/// slabs (slab index * objects per slab + local index), so a single free
+/// list spans the whole pool, and the slab owning an object is found by
+/// masking the object address. Slabs are never moved or released before
+/// the pool is destroyed, so pointers stay valid.
+///
+/// \note Lazy Initialization:
+/// \note Construction doesn't touch the pool memory. Slots that were never
+/// used are handed out by a bump index, the free list only links recycled
+/// slots. Both construction and reset() are O(1), and pages of large,
+/// sparsely used pools are only touched when first needed.
+///
+/// \note Generations:
+/// \note Every object slot has a generation counter, stored in a separate
+/// dense array. The counter is incremented when the slot is allocated and
+/// again when it is freed, so odd generations mark live objects. Handles
+/// carry the generation of the slot at allocation time, which lets stale
+/// handles (to freed or recycled slots) be detected in O(1).
 class PoolAllocator {
 public:
+  enum class Mode {
+    FIXED,   //!< capacity is fixed on construction
+    GROWABLE //!< new slabs are chained when the pool gets full
+  };
+  /// Generational handle to a pool object
+  struct Handle {
+    u32 index{0};
+    /// slot generation at allocation time, zero identifies an invalid handle
+    u32 generation{0};
+    [[nodiscard]] inline bool isValid() const { return generation != 0; }
+  };
   /****************************************************************************
                                  CONSTRUCTORS
   ****************************************************************************/
   PoolAllocator() = default;
   ///
   /// \param object_size_in_bytes
-  /// \param object_count
+  /// \param object_count total number of objects for FIXED pools and the
+  /// (minimum) number of objects per slab for GROWABLE pools
   /// \param context
-  PoolAllocator(u32 object_size_in_bytes, u32 object_count, mem::ContextType context = mem::ContextType::HEAP);
+  /// \param mode
+  PoolAllocator(u32 object_size_in_bytes, u32 object_count,
+                mem::ContextType context = mem::ContextType::GENERAL_PURPOSE,
+                Mode mode = Mode::FIXED);
   ///
   ~PoolAllocator();
+  PoolAllocator(const PoolAllocator &) = delete;
+  PoolAllocator &operator=(const PoolAllocator &) = delete;
   /****************************************************************************
                                     SIZE
   ****************************************************************************/
@@ -58,6 +97,16 @@ public:
   [[nodiscard]] u32 size() const;
   /// \return
   [[nodiscard]] u32 objectSizeInBytes() const;
+  /// \return number of slabs (always 1 for FIXED pools)
+  [[nodiscard]] u32 slabCount() const;
+  /// \return slab size in bytes (0 for FIXED pools)
+  [[nodiscard]] std::size_t slabSizeInBytes() const;
+  /// Frees all objects in O(1), keeping the capacity (and slabs).
+  /// Handles to previous objects become stale.
+  void reset();
+  /// \param ptr
+  /// \return true if ptr points into the pool memory
+  [[nodiscard]] bool owns(const void *ptr) const;
   /****************************************************************************
                                     ALLOCATION
   ****************************************************************************/
@@ -67,12 +116,80 @@ public:
   ///
   /// \param ptr
   void freeObject(void *ptr);
+  /// Allocates up to n objects in a single pass over the free list
+  /// \note Runs of consecutive free slots (as in fresh pools, or after
+  /// freeBatch of consecutive objects) are handed out by bumping a pointer.
+  /// \param n number of objects
+  /// \param out_ptrs receives the object addresses (room for n pointers)
+  /// \return number of allocated objects, less than n if the pool got full
+  u32 allocateBatch(u32 n, void **out_ptrs);
+  /// Frees n objects, relinking them into the free list in a single pass
+  /// \note Objects are relinked in the given order, so the next batch
+  /// allocation returns them in the same order.
+  /// \param ptrs live objects
+  /// \param n number of objects
+  void freeBatch(void *const *ptrs, u32 n);
+  /// \return handle to a new object, an invalid handle if the pool is full
+  Handle allocateHandle();
+  /// \param handle
+  /// \return INVALID_INPUT if the handle is stale
+  OdResult freeHandle(Handle handle);
+  /// \param handle
+  /// \return true if handle refers to a live object
+  [[nodiscard]] inline bool isAlive(Handle handle) const {
+    return handle.index < bump_ && (handle.generation & 1u) &&
+        generations_[handle.index] == handle.generation;
+  }
+  /// \param handle
+  /// \return pointer to the object, nullptr if the handle is stale
+  [[nodiscard]] void *get(Handle handle) const;
+  /// \param ptr live object
+  /// \return handle of the object
+  [[nodiscard]] Handle handleOf(const void *ptr) const;
+  /// \note The handle is alive only if the slot holds a live object.
+  /// \param index slot index (< capacity)
+  /// \return handle with the current generation of the slot
+  [[nodiscard]] inline Handle handleAt(u32 index) const {
+    return {index, generations_[index]};
+  }
 private:
+  /// free list terminator
+  static constexpr u32 null_index = 0xffffffffu;
+  /// Generation of a slot taken by the bump index. Its previous value may be
+  /// anything (uninitialized or left by a reset pool), the result is odd and
+  /// different from it.
+  /// \param generation
+  /// \return
+  static inline u32 nextAliveGeneration(u32 generation) { return (generation + 1) | 1u; }
+  /// \return index of the allocated object, capacity_ if the pool is full
+  u32 allocateIndex();
+  /// \param index
+  void freeIndex(u32 index);
+  /// Appends a new slab and puts its objects into the free list
+  /// \return false if the pool can't grow
+  bool addSlab();
+  /// \param index
+  /// \return address of the object of the given index
+  [[nodiscard]] u8 *objectAddress(u32 index) const;
+  /// \param ptr
+  /// \return index of the object at the given address
+  [[nodiscard]] u32 objectIndex(const void *ptr) const;
+
   u32 size_{0};
   u32 capacity_{0};
   u32 object_size_in_bytes_{0};
-  u32 head_{0};
+  /// first recycled slot
+  u32 head_{null_index};
+  /// slots in [bump_, capacity_) were never used since construction/reset
+  u32 bump_{0};
   void* data_{};
+  u32 *generations_{nullptr};
+  mem::ContextType context_{mem::ContextType::GENERAL_PURPOSE};
+  // growable pools
+  std::size_t slab_size_{0};
+  u32 objects_per_slab_{0};
+  std::vector<u8 *> slabs_;
+  u32 generations_capacity_{0};
 };
 
 }
@@ -0,0 +1,276 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file relocatable_heap.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/memory/relocatable_heap.h>
+#include <algorithm>
+#include <cstring>
+
+namespace odysseus {
+
+/******************************************************************************
+ *                               LAYOUT
+******************************************************************************/
+struct RelocatableHeap::Block {
+  /// block size, header included
+  std::size_t size;
+  /// handle table slot, null_index for freed blocks
+  u32 slot;
+  u32 padding;
+};
+struct RelocatableHeap::Slot {
+  /// block offset for live slots
+  std::size_t offset;
+  u32 generation;
+  /// next free slot for free slots
+  u32 next_free;
+};
+static constexpr std::size_t header_size = RelocatableHeap::align_size;
+static_assert(sizeof(RelocatableHeap::Block) <= header_size);
+static_assert(sizeof(RelocatableHeap::Slot) == 16);
+/******************************************************************************
+ *                                 HEAP
+******************************************************************************/
+RelocatableHeap::RelocatableHeap(std::size_t size_in_bytes) : capacity_{size_in_bytes} {
+  if (size_in_bytes)
+    data_ = new u8[size_in_bytes];
+  setup();
+}
+
+RelocatableHeap::RelocatableHeap(std::size_t size_in_bytes, byte *buffer) :
+    data_{buffer}, capacity_{size_in_bytes}, using_extern_memory_{true} {
+  setup();
+}
+
+RelocatableHeap::~RelocatableHeap() {
+  if (!using_extern_memory_)
+    delete[] data_;
+}
+
+std::size_t RelocatableHeap::capacityInBytes() const {
+  return capacity_;
+}
+
+std::size_t RelocatableHeap::availableSizeInBytes() const {
+  return limit() - top_;
+}
+
+std::size_t RelocatableHeap::fragmentedSizeInBytes() const {
+  return dead_bytes_ + (compacting_ ? scan_ - dest_ : 0);
+}
+
+std::size_t RelocatableHeap::sizeInBytes(Handle handle) const {
+  if (!isAlive(handle))
+    return 0;
+  return block(slot(handle.index).offset)->size - header_size;
+}
+
+RelocatableHeap::Handle RelocatableHeap::allocate(std::size_t size_in_bytes) {
+  if (!size_in_bytes)
+    return {};
+  const std::size_t block_size = mem::alignTo(size_in_bytes, align_size) + header_size;
+  const std::size_t table_growth = free_slot_ == null_index ? sizeof(Slot) : 0;
+  // a pass in progress leaves the holes freed below its cursor, keep
+  // compacting until the block fits or nothing is fragmented
+  while (top_ + block_size + table_growth > limit()) {
+    if (!fragmentedSizeInBytes())
+      return {};
+    compact();
+  }
+  u32 index = free_slot_;
+  if (index != null_index)
+    free_slot_ = slot(index).next_free;
+  else {
+    index = slot_count_++;
+    slot(index).generation = 0;
+  }
+  auto &s = slot(index);
+  s.generation = nextAliveGeneration(s.generation);
+  s.offset = top_;
+  auto *b = block(top_);
+  b->size = block_size;
+  b->slot = index;
+  top_ += block_size;
+  return {index, s.generation};
+}
+
+OdResult RelocatableHeap::freeHandle(Handle handle) {
+  if (!isAlive(handle))
+    return OdResult::INVALID_INPUT;
+  auto &s = slot(handle.index);
+  auto *b = block(s.offset);
+  if (s.offset + b->size == top_ && (!compacting_ || s.offset >= scan_))
+    // the last block is given back right away
+    top_ = s.offset;
+  else {
+    b->slot = null_index;
+    dead_bytes_ += b->size;
+    // blocks above the compaction cursor are collected by the current pass
+    if (!compacting_ || s.offset < dest_)
+      first_dead_ = std::min(first_dead_, s.offset);
+  }
+  ++s.generation;
+  s.next_free = free_slot_;
+  free_slot_ = handle.index;
+  return OdResult::SUCCESS;
+}
+
+bool RelocatableHeap::isAlive(Handle handle) const {
+  return handle.index < slot_count_ && (handle.generation & 1u) &&
+      slot(handle.index).generation == handle.generation;
+}
+
+void *RelocatableHeap::get(Handle handle) const {
+  if (!isAlive(handle))
+    return nullptr;
+  return heap_ + slot(handle.index).offset + header_size;
+}
+
+void RelocatableHeap::clear() {
+  // slots are kept (with new generations) so old handles stay stale
+  free_slot_ = null_index;
+  for (u32 i = slot_count_; i-- > 0;) {
+    auto &s = slot(i);
+    if (s.generation & 1u)
+      ++s.generation;
+    s.next_free = free_slot_;
+    free_slot_ = i;
+  }
+  top_ = 0;
+  dead_bytes_ = 0;
+  compacting_ = false;
+  first_dead_ = null_offset;
+}
+
+std::size_t RelocatableHeap::compact(std::size_t budget_in_bytes) {
+  if (!compacting_) {
+    if (!dead_bytes_)
+      return 0;
+    compacting_ = true;
+    scan_ = dest_ = first_dead_;
+    first_dead_ = null_offset;
+  }
+  std::size_t moved = 0;
+  std::size_t work = 0;
+  // visit at least one block, even with a zero budget
+  while (scan_ < top_ && (!work || work < budget_in_bytes)) {
+    auto *b = block(scan_);
+    const std::size_t size = b->size;
+    work += header_size;
+    if (b->slot == null_index)
+      dead_bytes_ -= size;
+    else {
+      if (dest_ != scan_) {
+        std::memmove(heap_ + dest_, b, size);
+        slot(block(dest_)->slot).offset = dest_;
+        moved += size;
+        work += size;
+      }
+      dest_ += size;
+    }
+    scan_ += size;
+  }
+  if (scan_ >= top_) {
+    top_ = dest_;
+    compacting_ = false;
+  }
+  return moved;
+}
+
+std::size_t RelocatableHeap::compactFor(std::chrono::microseconds budget) {
+  // check the clock every few blocks
+  static constexpr std::size_t step_budget = 16 * 1024;
+  const auto deadline = std::chrono::steady_clock::now() + budget;
+  std::size_t moved = 0;
+  do
+    moved += compact(step_budget);
+  while (compacting_ && std::chrono::steady_clock::now() < deadline);
+  return moved;
+}
+
+bool RelocatableHeap::isCompacting() const {
+  return compacting_;
+}
+
+void RelocatableHeap::setup() {
+  heap_ = mem::alignPointer(data_, align_size);
+  if (!data_ || capacity_ < static_cast<std::size_t>(heap_ - data_)) {
+    heap_ = table_end_ = data_;
+    return;
+  }
+  const std::size_t heap_size = capacity_ - (heap_ - data_);
+  table_end_ = heap_ + heap_size - heap_size % sizeof(Slot);
+}
+
+RelocatableHeap::Slot &RelocatableHeap::slot(u32 index) const {
+  return reinterpret_cast<Slot *>(table_end_)[-static_cast<std::ptrdiff_t>(index) - 1];
+}
+
+RelocatableHeap::Block *RelocatableHeap::block(std::size_t offset) const {
+  return reinterpret_cast<Block *>(heap_ + offset);
+}
+
+std::size_t RelocatableHeap::limit() const {
+  return (table_end_ - heap_) - slot_count_ * sizeof(Slot);
+}
+
+#ifdef ODYSSEUS_DEBUG
+std::vector<ponos::MemoryDumper::Region> RelocatableHeap::getRegions() {
+  std::vector<ponos::MemoryDumper::Region> regions = {
+      { // data_
+          offsetof(RelocatableHeap, data_),
+          sizeof(data_),
+          1,
+          ponos::ConsoleColors::color(1),
+          {}
+      },
+      { // capacity_
+          offsetof(RelocatableHeap, capacity_),
+          sizeof(capacity_),
+          1,
+          ponos::ConsoleColors::color(2),
+          {}
+      },
+      { // heap markers
+          offsetof(RelocatableHeap, heap_),
+          sizeof(heap_) + sizeof(table_end_) + sizeof(top_) + sizeof(dead_bytes_),
+          1,
+          ponos::ConsoleColors::color(3),
+          {}
+      },
+      { // handle table
+          offsetof(RelocatableHeap, slot_count_),
+          sizeof(slot_count_) + sizeof(free_slot_),
+          1,
+          ponos::ConsoleColors::color(4),
+          {}
+      },
+  };
+  return regions;
+}
+#endif
+
+}
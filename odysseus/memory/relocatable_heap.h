@@ -0,0 +1,170 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file relocatable_heap.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_MEMORY_RELOCATABLE_HEAP_H
+#define ODYSSEUS_ODYSSEUS_MEMORY_RELOCATABLE_HEAP_H
+
+#include <odysseus/memory/mem.h>
+#include <chrono>
+#include <limits>
+
+namespace odysseus {
+
+/// RAII Relocatable Heap
+/// Variable size blocks addressed only through handles, so the heap is free
+/// to move them. Blocks are bump allocated and freed blocks leave holes
+/// that an incremental compactor closes by sliding live blocks down, a few
+/// at a time, updating the handle table as they move. Calling compact once
+/// per frame with a small budget keeps a long running heap from
+/// fragmenting.
+///
+/// \note Memory Layout:
+/// \note Blocks grow upwards from the start of the memory block, each one
+/// with a 16 byte header (block size and slot index). The handle table
+/// grows downwards from the end of the memory block, freed slots are kept
+/// in a free list. Like PoolAllocator slots, a generation counter is
+/// incremented on allocation and release, so odd generations mark live
+/// blocks and stale handles are detected in O(1).
+///
+/// \note Pointers returned by get are only valid until the next call to
+/// allocate or compact, which may move the block.
+/// \note This class is not thread-safe.
+class RelocatableHeap {
+public:
+  /// Generational handle to a heap block
+  struct Handle {
+    u32 index{0};
+    /// slot generation at allocation time, zero identifies an invalid handle
+    u32 generation{0};
+    [[nodiscard]] inline bool isValid() const { return generation != 0; }
+  };
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  /// \param size_in_bytes
+  explicit RelocatableHeap(std::size_t size_in_bytes = 0);
+  /// \param size_in_bytes total memory capacity
+  /// \param buffer external allocated memory
+  RelocatableHeap(std::size_t size_in_bytes, byte *buffer);
+  ///
+  ~RelocatableHeap();
+  RelocatableHeap(const RelocatableHeap &) = delete;
+  RelocatableHeap &operator=(const RelocatableHeap &) = delete;
+  /****************************************************************************
+                                   SIZE
+  ****************************************************************************/
+  /// \return total memory capacity (in bytes)
+  [[nodiscard]] std::size_t capacityInBytes() const;
+  /// \return contiguous free memory above the last block (in bytes)
+  [[nodiscard]] std::size_t availableSizeInBytes() const;
+  /// \return memory held by freed blocks not yet compacted (in bytes)
+  [[nodiscard]] std::size_t fragmentedSizeInBytes() const;
+  /// \param handle
+  /// \return usable size of the block (in bytes), 0 for stale handles
+  [[nodiscard]] std::size_t sizeInBytes(Handle handle) const;
+  /****************************************************************************
+                                    ALLOCATION
+  ****************************************************************************/
+  /// \note When there is no room left above the last block, the current
+  /// \note compaction is finished synchronously before giving up.
+  /// \param size_in_bytes
+  /// \return handle to a 16 byte aligned block, an invalid handle if the
+  /// heap is full
+  Handle allocate(std::size_t size_in_bytes);
+  /// \param handle
+  /// \return INVALID_INPUT if the handle is stale
+  OdResult freeHandle(Handle handle);
+  /// \param handle
+  /// \return true if handle refers to a live block
+  [[nodiscard]] bool isAlive(Handle handle) const;
+  /// \param handle
+  /// \return pointer to the block, nullptr if the handle is stale
+  [[nodiscard]] void *get(Handle handle) const;
+  /// Frees all blocks, invalidating all handles
+  void clear();
+  /****************************************************************************
+                                  COMPACTION
+  ****************************************************************************/
+  /// Advances the compaction, sliding live blocks over the freed ones.
+  /// \note At least one block is visited per call, so blocks larger than
+  /// \note the budget still move.
+  /// \param budget_in_bytes bytes moved (plus 16 bytes per visited block)
+  /// before the call returns
+  /// \return number of bytes moved
+  std::size_t compact(std::size_t budget_in_bytes = std::numeric_limits<std::size_t>::max());
+  /// Advances the compaction until it finishes or the time budget runs out.
+  /// \param budget
+  /// \return number of bytes moved
+  std::size_t compactFor(std::chrono::microseconds budget);
+  /// \return true if a compaction is in progress
+  [[nodiscard]] bool isCompacting() const;
+  /****************************************************************************
+                                   DEBUG
+  ****************************************************************************/
+#ifdef ODYSSEUS_DEBUG
+  [[nodiscard]]static std::vector<ponos::MemoryDumper::Region> getRegions();
+#endif
+
+  static constexpr std::size_t align_size = 16;
+  /// block header (see Memory Layout)
+  struct Block;
+  /// handle table entry
+  struct Slot;
+
+private:
+  static constexpr u32 null_index = 0xffffffffu;
+  static constexpr std::size_t null_offset = std::numeric_limits<std::size_t>::max();
+  static inline u32 nextAliveGeneration(u32 generation) { return (generation + 1) | 1u; }
+  /// Carves the heap and the handle table from data_
+  void setup();
+  [[nodiscard]] Slot &slot(u32 index) const;
+  [[nodiscard]] Block *block(std::size_t offset) const;
+  /// \return bytes between the heap start and the handle table
+  [[nodiscard]] std::size_t limit() const;
+
+  byte *data_{nullptr};
+  std::size_t capacity_{0};
+  bool using_extern_memory_{false};
+  // heap
+  byte *heap_{nullptr};
+  byte *table_end_{nullptr};
+  std::size_t top_{0};
+  std::size_t dead_bytes_{0};
+  // handle table
+  u32 slot_count_{0};
+  u32 free_slot_{null_index};
+  // compaction
+  bool compacting_{false};
+  std::size_t scan_{0};
+  std::size_t dest_{0};
+  // lowest freed block the next compaction starts from
+  std::size_t first_dead_{null_offset};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_MEMORY_RELOCATABLE_HEAP_H
@@ -0,0 +1,156 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file ring_buffer_allocator.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/memory/ring_buffer_allocator.h>
+
+namespace odysseus {
+
+RingBufferAllocator::RingBufferAllocator(std::size_t size_in_bytes) : capacity_{size_in_bytes} {
+  if (size_in_bytes)
+    data_ = new u8[size_in_bytes];
+}
+
+RingBufferAllocator::RingBufferAllocator(std::size_t size_in_bytes, byte *buffer) :
+    data_{buffer}, capacity_{size_in_bytes}, using_extern_memory_{true} {}
+
+RingBufferAllocator::~RingBufferAllocator() {
+  if (!using_extern_memory_)
+    delete[] data_;
+}
+
+std::size_t RingBufferAllocator::capacityInBytes() const {
+  return capacity_;
+}
+
+std::size_t RingBufferAllocator::availableSizeInBytes() const {
+  return capacity_ - (head_ - tail_);
+}
+
+bool RingBufferAllocator::owns(const void *ptr) const {
+  return ptr >= data_ && ptr < data_ + capacity_;
+}
+
+void *RingBufferAllocator::allocate(std::size_t size_in_bytes, std::size_t align) {
+  if (!size_in_bytes || !capacity_)
+    return nullptr;
+  // an empty ring starts over from the beginning of the buffer, otherwise
+  // the bytes skipped at its end would count as used
+  if (head_ == tail_ && head_ % capacity_)
+    head_ = tail_ = (head_ / capacity_ + 1) * capacity_;
+  u64 head = head_;
+  std::size_t offset = head % capacity_;
+  std::size_t shift = mem::rightAlignShift(reinterpret_cast<uintptr_t>(data_ + offset), align);
+  if (offset + shift + size_in_bytes > capacity_) {
+    // skip the end of the buffer, blocks never wrap around
+    head += capacity_ - offset;
+    offset = 0;
+    shift = mem::rightAlignShift(reinterpret_cast<uintptr_t>(data_), align);
+  }
+  if (head + shift + size_in_bytes - tail_ > capacity_)
+    return nullptr;
+  head_ = head + shift + size_in_bytes;
+  return data_ + offset + shift;
+}
+
+void RingBufferAllocator::clear() {
+  head_ = tail_ = 0;
+  retired_fence_ = current_fence_ - 1;
+  first_fence_ = fence_count_ = 0;
+}
+
+u64 RingBufferAllocator::currentFence() const {
+  return current_fence_;
+}
+
+u64 RingBufferAllocator::retiredFence() const {
+  return retired_fence_;
+}
+
+u64 RingBufferAllocator::closeFence() {
+  const u64 fence = current_fence_++;
+  const u32 last = (first_fence_ + fence_count_ + max_fence_count - 1) % max_fence_count;
+  // fences without blocks need no record
+  if (head_ == (fence_count_ ? fences_[last].end : tail_))
+    return fence;
+  if (fence_count_ == max_fence_count)
+    // the newest record takes this fence too
+    fences_[last] = {fence, head_};
+  else
+    fences_[(first_fence_ + fence_count_++) % max_fence_count] = {fence, head_};
+  return fence;
+}
+
+OdResult RingBufferAllocator::retire(u64 fence) {
+  if (fence >= current_fence_)
+    return OdResult::INVALID_INPUT;
+  while (fence_count_ && fences_[first_fence_].fence <= fence) {
+    tail_ = fences_[first_fence_].end;
+    first_fence_ = (first_fence_ + 1) % max_fence_count;
+    --fence_count_;
+  }
+  if (fence > retired_fence_)
+    retired_fence_ = fence;
+  return OdResult::SUCCESS;
+}
+
+#ifdef ODYSSEUS_DEBUG
+std::vector<ponos::MemoryDumper::Region> RingBufferAllocator::getRegions() {
+  std::vector<ponos::MemoryDumper::Region> regions = {
+      { // data_
+          offsetof(RingBufferAllocator, data_),
+          sizeof(data_),
+          1,
+          ponos::ConsoleColors::color(1),
+          {}
+      },
+      { // capacity_
+          offsetof(RingBufferAllocator, capacity_),
+          sizeof(capacity_),
+          1,
+          ponos::ConsoleColors::color(2),
+          {}
+      },
+      { // positions
+          offsetof(RingBufferAllocator, head_),
+          sizeof(head_) + sizeof(tail_),
+          1,
+          ponos::ConsoleColors::color(3),
+          {}
+      },
+      { // fences
+          offsetof(RingBufferAllocator, current_fence_),
+          sizeof(current_fence_) + sizeof(retired_fence_) + sizeof(fences_),
+          1,
+          ponos::ConsoleColors::color(4),
+          {}
+      },
+  };
+  return regions;
+}
+#endif
+
+}
@@ -0,0 +1,128 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file ring_buffer_allocator.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_MEMORY_RING_BUFFER_ALLOCATOR_H
+#define ODYSSEUS_ODYSSEUS_MEMORY_RING_BUFFER_ALLOCATOR_H
+
+#include <odysseus/memory/mem.h>
+
+namespace odysseus {
+
+/// RAII Ring Buffer Allocator
+/// Circular allocator for data with FIFO lifetimes, such as streaming and
+/// upload staging buffers consumed a few frames after they are written.
+/// Allocations are tagged with the current fence value; closeFence starts
+/// a new fence and retire(fence) reclaims, in bulk, every allocation made
+/// up to that fence.
+///
+/// \note Blocks are always contiguous: a block that does not fit before
+/// the end of the buffer starts over at the beginning, and the skipped
+/// bytes are reclaimed with the fence of that block.
+/// \note At most max_fence_count closed fences are tracked, older fences
+/// are merged into newer ones (and retired later) when the limit is hit.
+/// \note This class is not thread-safe.
+class RingBufferAllocator {
+public:
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  /// \param size_in_bytes
+  explicit RingBufferAllocator(std::size_t size_in_bytes = 0);
+  /// \param size_in_bytes total memory capacity
+  /// \param buffer external allocated memory
+  RingBufferAllocator(std::size_t size_in_bytes, byte *buffer);
+  ///
+  ~RingBufferAllocator();
+  RingBufferAllocator(const RingBufferAllocator &) = delete;
+  RingBufferAllocator &operator=(const RingBufferAllocator &) = delete;
+  /****************************************************************************
+                                   SIZE
+  ****************************************************************************/
+  /// \return total memory capacity (in bytes)
+  [[nodiscard]] std::size_t capacityInBytes() const;
+  /// \note Part of this size may be skipped to keep blocks contiguous.
+  /// \return memory not held by unretired fences (in bytes)
+  [[nodiscard]] std::size_t availableSizeInBytes() const;
+  /// \param ptr
+  /// \return true if ptr lies in this allocator's memory
+  [[nodiscard]] bool owns(const void *ptr) const;
+  /****************************************************************************
+                                    ALLOCATION
+  ****************************************************************************/
+  /// \param size_in_bytes
+  /// \param align power of two alignment
+  /// \return pointer to a block tagged with the current fence, nullptr if
+  /// there is no room until older fences are retired
+  void *allocate(std::size_t size_in_bytes, std::size_t align = 1);
+  /// Frees all blocks and fences
+  void clear();
+  /****************************************************************************
+                                   FENCES
+  ****************************************************************************/
+  /// \return fence value given to new allocations
+  [[nodiscard]] u64 currentFence() const;
+  /// \return last retired fence value (0 if none)
+  [[nodiscard]] u64 retiredFence() const;
+  /// Closes the current fence, new allocations get the next fence value.
+  /// \return the fence value of the allocations made since the last call
+  u64 closeFence();
+  /// Reclaims all allocations tagged with fence values up to fence.
+  /// \param fence closed fence value
+  /// \return INVALID_INPUT if fence was not closed yet
+  OdResult retire(u64 fence);
+  /****************************************************************************
+                                   DEBUG
+  ****************************************************************************/
+#ifdef ODYSSEUS_DEBUG
+  [[nodiscard]]static std::vector<ponos::MemoryDumper::Region> getRegions();
+#endif
+
+  static constexpr u32 max_fence_count = 64;
+
+private:
+  /// Closed fence and the position right after its last block
+  struct FenceRecord {
+    u64 fence;
+    u64 end;
+  };
+
+  byte *data_{nullptr};
+  std::size_t capacity_{0};
+  bool using_extern_memory_{false};
+  // positions grow forever, offsets are positions modulo capacity_
+  u64 head_{0};
+  u64 tail_{0};
+  u64 current_fence_{1};
+  u64 retired_fence_{0};
+  FenceRecord fences_[max_fence_count]{};
+  u32 first_fence_{0};
+  u32 fence_count_{0};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_MEMORY_RING_BUFFER_ALLOCATOR_H
@@ -0,0 +1,175 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file small_object_allocator.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/memory/small_object_allocator.h>
+#include <algorithm>
+
+namespace odysseus {
+
+// (size + 15) / 16 -> size class
+const u8 SmallObjectAllocator::class_table_[max_object_size / 16 + 1] = {
+    0, 0, 1, 2, 3, 4, 5, 6, 7,            // 0 - 128
+    8, 8, 9, 9, 10, 10, 11, 11,           // 144 - 256
+    12, 12, 12, 12, 13, 13, 13, 13,       // 272 - 384
+    14, 14, 14, 14, 15, 15, 15, 15        // 400 - 512
+};
+
+const u16 SmallObjectAllocator::class_sizes_[size_class_count] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512
+};
+
+// slab header
+struct SlabHeader {
+  u32 size_class;
+};
+static_assert(sizeof(SlabHeader) <= SmallObjectAllocator::slab_header_size);
+
+SmallObjectAllocator::SmallObjectAllocator(std::size_t size_in_bytes) : capacity_{size_in_bytes} {
+  if (size_in_bytes) {
+    // room for aligning the first slab
+    capacity_ += slab_size;
+    data_ = new u8[capacity_];
+  }
+  reset();
+}
+
+SmallObjectAllocator::SmallObjectAllocator(std::size_t size_in_bytes, byte *buffer) :
+    data_{buffer}, capacity_{size_in_bytes}, using_extern_memory_{true} {
+  reset();
+}
+
+SmallObjectAllocator::~SmallObjectAllocator() {
+  if (!using_extern_memory_)
+    delete[] data_;
+}
+
+std::size_t SmallObjectAllocator::capacityInBytes() const {
+  return capacity_;
+}
+
+u32 SmallObjectAllocator::slabCount() const {
+  return slab_count_;
+}
+
+u32 SmallObjectAllocator::availableSlabCount() const {
+  return slab_count_ - next_slab_;
+}
+
+std::size_t SmallObjectAllocator::blockSizeInBytes(const void *ptr) {
+  const auto slab = reinterpret_cast<uintptr_t>(ptr) & ~(slab_size - 1);
+  return class_sizes_[reinterpret_cast<const SlabHeader *>(slab)->size_class];
+}
+
+bool SmallObjectAllocator::owns(const void *ptr) const {
+  return ptr >= slabs_ && ptr < slabs_ + static_cast<std::size_t>(slab_count_) * slab_size;
+}
+
+void *SmallObjectAllocator::allocate(std::size_t size_in_bytes) {
+  if (size_in_bytes > max_object_size)
+    return nullptr;
+  const u32 size_class = sizeClass(size_in_bytes);
+  auto &c = classes_[size_class];
+  if (c.free_list) {
+    void *ptr = c.free_list;
+    c.free_list = *reinterpret_cast<void **>(ptr);
+    return ptr;
+  }
+  if (c.bump == c.bump_end && !addSlab(size_class))
+    return nullptr;
+  void *ptr = c.bump;
+  c.bump += class_sizes_[size_class];
+  return ptr;
+}
+
+void SmallObjectAllocator::freeBlock(void *ptr) {
+  if (!ptr)
+    return;
+  const auto slab = reinterpret_cast<uintptr_t>(ptr) & ~(slab_size - 1);
+  auto &c = classes_[reinterpret_cast<const SlabHeader *>(slab)->size_class];
+  *reinterpret_cast<void **>(ptr) = c.free_list;
+  c.free_list = ptr;
+}
+
+void SmallObjectAllocator::reset() {
+  slabs_ = mem::alignPointer(data_, slab_size);
+  slab_count_ = 0;
+  if (data_ && slabs_ < data_ + capacity_)
+    slab_count_ = static_cast<u32>((data_ + capacity_ - slabs_) / slab_size);
+  next_slab_ = 0;
+  std::fill(std::begin(classes_), std::end(classes_), SizeClass());
+}
+
+bool SmallObjectAllocator::addSlab(u32 size_class) {
+  if (next_slab_ >= slab_count_)
+    return false;
+  byte *slab = slabs_ + static_cast<std::size_t>(next_slab_++) * slab_size;
+  reinterpret_cast<SlabHeader *>(slab)->size_class = size_class;
+  auto &c = classes_[size_class];
+  const std::size_t block_size = class_sizes_[size_class];
+  c.bump = slab + slab_header_size;
+  // the slab tail that doesn't fit a whole block is left unused
+  c.bump_end = c.bump + (slab_size - slab_header_size) / block_size * block_size;
+  return true;
+}
+
+#ifdef ODYSSEUS_DEBUG
+std::vector<ponos::MemoryDumper::Region> SmallObjectAllocator::getRegions() {
+  std::vector<ponos::MemoryDumper::Region> regions = {
+      { // data_
+          offsetof(SmallObjectAllocator, data_),
+          sizeof(data_),
+          1,
+          ponos::ConsoleColors::color(1),
+          {}
+      },
+      { // capacity_
+          offsetof(SmallObjectAllocator, capacity_),
+          sizeof(capacity_),
+          1,
+          ponos::ConsoleColors::color(2),
+          {}
+      },
+      { // slabs
+          offsetof(SmallObjectAllocator, slabs_),
+          sizeof(slabs_) + sizeof(slab_count_) + sizeof(next_slab_),
+          1,
+          ponos::ConsoleColors::color(3),
+          {}
+      },
+      { // classes_
+          offsetof(SmallObjectAllocator, classes_),
+          sizeof(classes_),
+          1,
+          ponos::ConsoleColors::color(4),
+          {}
+      },
+  };
+  return regions;
+}
+#endif
+
+}
@@ -0,0 +1,161 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file small_object_allocator.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_MEMORY_SMALL_OBJECT_ALLOCATOR_H
+#define ODYSSEUS_ODYSSEUS_MEMORY_SMALL_OBJECT_ALLOCATOR_H
+
+#include <odysseus/memory/mem.h>
+#include <new>
+
+namespace odysseus {
+
+/// RAII Segregated Size Class Allocator
+/// Serves small blocks (up to max_object_size bytes) of mixed sizes. Each
+/// request is rounded up to one of size_class_count size classes, found
+/// through a lookup table, and each size class allocates from its own slabs
+/// like a growable PoolAllocator.
+///
+/// \note Size classes: 16 byte steps up to 128 bytes, then 4 classes per
+/// power of two (160, 192, 224, 256, 320, ..., 512). Blocks are 16 byte
+/// aligned.
+/// \note Slabs: the memory is split in slabs of slab_size bytes, aligned to
+/// their own size, that are handed to size classes on demand. A slab starts
+/// with a cache line holding its size class, so the owner of any block is
+/// found by masking its address. Each size class keeps a free list of
+/// recycled blocks and bumps a pointer through its newest slab. Slabs are
+/// never given back to other classes before reset().
+///
+/// \note This class is not thread-safe.
+class SmallObjectAllocator {
+public:
+  static constexpr std::size_t max_object_size = 512;
+  static constexpr u32 size_class_count = 16;
+  static constexpr std::size_t slab_size = 64 * 1024;
+  static constexpr std::size_t slab_header_size = 64;
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  /// \param size_in_bytes
+  explicit SmallObjectAllocator(std::size_t size_in_bytes = 0);
+  /// \note Slabs start at the first slab_size aligned address of the buffer.
+  /// \param size_in_bytes total memory capacity
+  /// \param buffer external allocated memory
+  SmallObjectAllocator(std::size_t size_in_bytes, byte *buffer);
+  ///
+  ~SmallObjectAllocator();
+  SmallObjectAllocator(const SmallObjectAllocator &) = delete;
+  SmallObjectAllocator &operator=(const SmallObjectAllocator &) = delete;
+  /****************************************************************************
+                                   SIZE
+  ****************************************************************************/
+  /// \return total memory capacity (in bytes)
+  [[nodiscard]] std::size_t capacityInBytes() const;
+  /// \return total number of slabs
+  [[nodiscard]] u32 slabCount() const;
+  /// \return number of slabs not yet given to a size class
+  [[nodiscard]] u32 availableSlabCount() const;
+  /// \param size_in_bytes (<= max_object_size)
+  /// \return size class index
+  [[nodiscard]] static inline u32 sizeClass(std::size_t size_in_bytes) {
+    return class_table_[(size_in_bytes + 15) >> 4];
+  }
+  /// \param size_class
+  /// \return block size of the size class (in bytes)
+  [[nodiscard]] static inline std::size_t classSizeInBytes(u32 size_class) {
+    return class_sizes_[size_class];
+  }
+  /// \param ptr block returned by allocate
+  /// \return usable size of the block (in bytes)
+  [[nodiscard]] static std::size_t blockSizeInBytes(const void *ptr);
+  /// \param ptr
+  /// \return true if ptr lies in this allocator's memory
+  [[nodiscard]] bool owns(const void *ptr) const;
+  /****************************************************************************
+                                    ALLOCATION
+  ****************************************************************************/
+  /// \param size_in_bytes
+  /// \return pointer to a 16 byte aligned block, nullptr if size_in_bytes is
+  /// larger than max_object_size or there are no slabs left
+  void *allocate(std::size_t size_in_bytes);
+  /// \param ptr block returned by allocate (nullptr is ignored)
+  void freeBlock(void *ptr);
+  /// Frees all blocks and returns all slabs
+  void reset();
+  /****************************************************************************
+                                   DEBUG
+  ****************************************************************************/
+#ifdef ODYSSEUS_DEBUG
+  [[nodiscard]]static std::vector<ponos::MemoryDumper::Region> getRegions();
+#endif
+
+private:
+  struct SizeClass {
+    /// recycled blocks, linked through their first bytes
+    void *free_list{nullptr};
+    /// never used blocks of the newest slab
+    byte *bump{nullptr};
+    byte *bump_end{nullptr};
+  };
+  /// Gives a new slab to the size class
+  /// \return false if there are no slabs left
+  bool addSlab(u32 size_class);
+
+  static const u8 class_table_[max_object_size / 16 + 1];
+  static const u16 class_sizes_[size_class_count];
+
+  byte *data_{nullptr};
+  std::size_t capacity_{0};
+  byte *slabs_{nullptr};
+  u32 slab_count_{0};
+  u32 next_slab_{0};
+  SizeClass classes_[size_class_count];
+  bool using_extern_memory_{false};
+};
+
+/// Base class that routes new/delete of derived types to the SMALL_OBJECT
+/// context (see mem::allocateBlock)
+/// \note Objects larger than SmallObjectAllocator::max_object_size go to the
+/// GENERAL_PURPOSE context.
+/// \note Single thread only: neither context is synchronized, so SmallObject
+/// types must not be created or deleted concurrently (e.g. inside JobSystem
+/// jobs). Use per-worker memory (JobSystem::scratch, mem::frameArena) or a
+/// ConcurrentPoolAllocator there.
+struct SmallObject {
+  static void *operator new(std::size_t size_in_bytes) {
+    auto *ptr = mem::allocateBlock(size_in_bytes, mem::ContextType::SMALL_OBJECT);
+    if (!ptr)
+      throw std::bad_alloc();
+    return ptr;
+  }
+  static void operator delete(void *ptr) noexcept {
+    mem::freeBlock(ptr);
+  }
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_MEMORY_SMALL_OBJECT_ALLOCATOR_H
@@ -27,101 +27,133 @@
 
 #include <odysseus/memory/stack_allocator.h>
 #include <odysseus/memory/mem.h>
+#include <algorithm>
 
 namespace odysseus {
 
-#define SA_EXTRACT_MARKER(HANDLE) \
-  ((HANDLE & 0xffffff) - 1)
-
-#define SA_BUILD_HANDLE(MARKER, SHIFT) \
-  ((MARKER + 1u) | (SHIFT << 24u))
-
-StackAllocator::StackAllocator(std::size_t size_in_bytes) {
+template<class HandleLayout, class Tracking>
+BasicStackAllocator<HandleLayout, Tracking>::BasicStackAllocator(std::size_t size_in_bytes) {
   resize(size_in_bytes);
 }
 
-StackAllocator::StackAllocator(std::size_t size_in_bytes, byte *buffer) :
-    data_(buffer), capacity_(size_in_bytes), using_extern_memory_{true} {
+template<class HandleLayout, class Tracking>
+BasicStackAllocator<HandleLayout, Tracking>::BasicStackAllocator(std::size_t size_in_bytes, byte *buffer) :
+    data_(buffer), capacity_(std::min(size_in_bytes, HandleLayout::max_capacity)),
+    using_extern_memory_{true} {
 }
 
-StackAllocator::~StackAllocator() {
+template<class HandleLayout, class Tracking>
+BasicStackAllocator<HandleLayout, Tracking>::~BasicStackAllocator() {
+  runFinalizers(0);
   if (!using_extern_memory_)
     delete[] data_;
 }
 
-std::size_t StackAllocator::capacityInBytes() const {
+template<class HandleLayout, class Tracking>
+std::size_t BasicStackAllocator<HandleLayout, Tracking>::capacityInBytes() const {
   return capacity_;
 }
 
-std::size_t StackAllocator::availableSizeInBytes() const {
-  return capacity_ - marker_;
+template<class HandleLayout, class Tracking>
+std::size_t BasicStackAllocator<HandleLayout, Tracking>::availableSizeInBytes() const {
+  // failed concurrent allocations may leave the marker past the capacity
+  return capacity_ - std::min(marker_.load(std::memory_order_relaxed), capacity_);
 }
 
-OdResult StackAllocator::resize(std::size_t size_in_bytes) {
-  if (!using_extern_memory_)
-    delete[] data_;
-  else
+template<class HandleLayout, class Tracking>
+OdResult BasicStackAllocator<HandleLayout, Tracking>::resize(std::size_t size_in_bytes) {
+  if (using_extern_memory_)
     return OdResult::BAD_OPERATION;
-  marker_ = 0;
+  if (size_in_bytes > HandleLayout::max_capacity)
+    return OdResult::OUT_OF_BOUNDS;
+  runFinalizers(0);
+  delete[] data_;
+  data_ = nullptr;
+  marker_.store(0, std::memory_order_relaxed);
   capacity_ = size_in_bytes;
   if (size_in_bytes)
     data_ = new u8[size_in_bytes];
-  ODYSSEUS_DEBUG_CODE(db_handles.clear();
-                          db_regions.clear();)
+  tracking_.onClear();
   return OdResult::SUCCESS;
 }
 
-MemHandle StackAllocator::allocate(std::size_t block_size_in_bytes, std::size_t align) {
+template<class HandleLayout, class Tracking>
+MemHandle BasicStackAllocator<HandleLayout, Tracking>::allocate(std::size_t block_size_in_bytes, std::size_t align) {
+  const auto marker = marker_.load(std::memory_order_relaxed);
   std::size_t
-      actual_size = block_size_in_bytes + mem::rightAlignShift(reinterpret_cast<uintptr_t >(data_ ) + marker_, align);
+      actual_size = block_size_in_bytes + mem::rightAlignShift(reinterpret_cast<uintptr_t >(data_ ) + marker, align);
   std::size_t shift = actual_size - block_size_in_bytes;
-  if (actual_size > capacity_ - marker_)
+  if (marker > capacity_ || actual_size > capacity_ - marker)
     return {0};
-  const auto marker = marker_;
-  marker_ += actual_size;
-  ODYSSEUS_DEBUG_CODE(db_handles.emplace_back(marker);
-                          db_regions.push_back({
-                                                   marker,
-                                                   actual_size,
-                                                   1,
-                                                   ponos::ConsoleColors::color(db_handles.size()),
-                                                   {}
-                                               });
-  )
-  return {SA_BUILD_HANDLE(marker + shift, shift)};
+  marker_.store(marker + actual_size, std::memory_order_relaxed);
+  tracking_.onAllocate(marker, actual_size);
+  return {HandleLayout::build(marker + shift, shift)};
 }
 
-OdResult StackAllocator::freeTo(MemHandle handle) {
-  if (!marker_)
+template<class HandleLayout, class Tracking>
+MemHandle BasicStackAllocator<HandleLayout, Tracking>::allocateConcurrent(std::size_t block_size_in_bytes,
+                                                                          std::size_t align) {
+  if (align <= 1) {
+    // no padding, a single fetch_add claims the block
+    const auto marker = marker_.fetch_add(block_size_in_bytes, std::memory_order_relaxed);
+    if (marker > capacity_ || block_size_in_bytes > capacity_ - marker)
+      return {0};
+    return {HandleLayout::build(marker, 0)};
+  }
+  // the padding depends on the marker, retry if another thread moved it
+  auto marker = marker_.load(std::memory_order_relaxed);
+  std::size_t shift;
+  do {
+    shift = mem::rightAlignShift(reinterpret_cast<uintptr_t >(data_) + marker, align);
+    if (marker > capacity_ || block_size_in_bytes + shift > capacity_ - marker)
+      return {0};
+  } while (!marker_.compare_exchange_weak(marker, marker + shift + block_size_in_bytes,
+                                          std::memory_order_relaxed));
+  return {HandleLayout::build(marker + shift, shift)};
+}
+
+template<class HandleLayout, class Tracking>
+OdResult BasicStackAllocator<HandleLayout, Tracking>::freeTo(MemHandle handle) {
+  if (!marker_.load(std::memory_order_relaxed))
     return OdResult::BAD_OPERATION;
   if (!handle.id)
     return OdResult::INVALID_INPUT;
-  marker_ = SA_EXTRACT_MARKER(handle.id);
-  ODYSSEUS_DEBUG_CODE(
-      std::size_t db_i = 0;
-      for (std::size_t i = 0; i < db_handles.size(); ++i)
-        if (db_handles[i] == marker_)
-          db_i = i;
-      db_handles.resize(db_i);
-      db_regions.resize(db_i);)
+  const auto marker = HandleLayout::extractMarker(handle.id);
+  marker_.store(marker, std::memory_order_relaxed);
+  runFinalizers(marker);
+  tracking_.onFreeTo(marker);
   return OdResult::SUCCESS;
 }
 
-void StackAllocator::clear() {
-  ODYSSEUS_DEBUG_CODE(db_handles.clear();
-                          db_regions.clear();)
-  marker_ = 0;
+template<class HandleLayout, class Tracking>
+void BasicStackAllocator<HandleLayout, Tracking>::clear() {
+  runFinalizers(0);
+  tracking_.onClear();
+  marker_.store(0, std::memory_order_relaxed);
+}
+
+template<class HandleLayout, class Tracking>
+void BasicStackAllocator<HandleLayout, Tracking>::runFinalizers(std::size_t marker) {
+  // records are pushed after their objects, so the chain is sorted by
+  // address and everything at or above the marker sits at its head
+  while (finalizers_ && reinterpret_cast<byte *>(finalizers_) >= data_ + marker) {
+    auto *record = finalizers_;
+    finalizers_ = record->next;
+    record->destroy(record->object);
+  }
 }
 
 #ifdef ODYSSEUS_DEBUG
-void StackAllocator::dump(std::size_t start, std::size_t size) const {
+template<class HandleLayout, class Tracking>
+void BasicStackAllocator<HandleLayout, Tracking>::dump(std::size_t start, std::size_t size) const {
   ponos::MemoryDumper::dump(data_ + start, size ? size : capacity_ - start,
                             64, ponos::memory_dumper_options::colored_output
                                 | ponos::memory_dumper_options::cache_align,
-                            db_regions);
+                            getDataRegions());
 }
 
-std::vector<ponos::MemoryDumper::Region> StackAllocator::getRegions() {
+template<class HandleLayout, class Tracking>
+std::vector<ponos::MemoryDumper::Region> BasicStackAllocator<HandleLayout, Tracking>::getRegions() {
   std::vector<ponos::MemoryDumper::Region> regions = {
       { // data_
           0,
@@ -151,16 +183,16 @@ std::vector<ponos::MemoryDumper::Region> StackAllocator::getRegions() {
           ponos::ConsoleColors::color(4),
           {}
       },
-      { // db_handles
-          offsetof(StackAllocator, db_handles),
-          sizeof(db_handles),
+      { // tracking_
+          offsetof(BasicStackAllocator, tracking_),
+          sizeof(tracking_),
           1,
           ponos::ConsoleColors::color(5),
           {}
       },
-      { // db_regions
-          offsetof(StackAllocator, db_regions),
-          sizeof(db_regions),
+      { // finalizers_
+          offsetof(BasicStackAllocator, finalizers_),
+          sizeof(finalizers_),
           1,
           ponos::ConsoleColors::color(6),
           {}
@@ -169,12 +201,20 @@ std::vector<ponos::MemoryDumper::Region> StackAllocator::getRegions() {
   return std::move(regions);
 }
 
-std::vector<ponos::MemoryDumper::Region> StackAllocator::getDataRegions() {
-  return db_regions;
+template<class HandleLayout, class Tracking>
+std::vector<ponos::MemoryDumper::Region> BasicStackAllocator<HandleLayout, Tracking>::getDataRegions() const {
+  if constexpr (Tracking::keeps_regions)
+    return tracking_.regions();
+  else
+    return {};
 }
 #endif
 
-#undef SA_EXTRACT_MARKER
-#undef SA_BUILD_HANDLE
+template class BasicStackAllocator<SmallMemHandleLayout, NoTracking>;
+template class BasicStackAllocator<SmallMemHandleLayout, CountTracking>;
+template class BasicStackAllocator<SmallMemHandleLayout, RegionTracking>;
+template class BasicStackAllocator<WideMemHandleLayout, NoTracking>;
+template class BasicStackAllocator<WideMemHandleLayout, CountTracking>;
+template class BasicStackAllocator<WideMemHandleLayout, RegionTracking>;
 
 }
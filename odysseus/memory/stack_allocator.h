@@ -30,29 +30,51 @@
 
 #include <odysseus/memory/mem.h>
 #include <ponos/common/defs.h>
+#include <atomic>
+#include <type_traits>
 
 namespace odysseus {
 
 /// RAII Stack Allocator
 ///
 /// \note Handle Construction:
-/// \note The most significant byte of the handle is used to store the alignment
-/// shift and the rest is used to store the address offset + 1 of the first
-/// byte of the allocated block. Suppose the alignment requires a shift of
-/// 3 bytes and the allocated block would start at byte with offset 10.
-/// A 32 bit handle id in this case will have the value of 0x3000000A.
-class StackAllocator {
+/// \note The handle layout defines how the handle id is split. The upper bits
+/// of the handle are used to store the alignment shift and the lower bits
+/// are used to store the address offset + 1 of the first byte of the
+/// allocated block. Suppose the alignment requires a shift of 3 bytes and
+/// the allocated block would start at byte with offset 10. A 32 bit handle
+/// id (SmallMemHandleLayout) in this case will have the value of 0x0300000B.
+/// \note The capacity is limited by HandleLayout::max_capacity. The
+/// external buffer constructor clamps larger sizes (resize fails instead),
+/// mem contexts refuse them.
+/// \note Destructors: objects created with allocateTracked get a finalizer
+/// record placed right after them in the stack. Records form a chain (newest
+/// first) that freeTo, clear, resize and the destructor walk to destroy every
+/// object above the new top, in reverse order of creation. Trivially
+/// destructible types never get a record.
+/// \note Concurrency: allocateConcurrent may be called by many threads at
+/// once (jobs sharing a frame arena), it bumps the marker atomically.
+/// Everything else, including freeTo and clear, is single-threaded and
+/// meant for frame boundaries. Concurrent allocations are not reported to
+/// the tracking policy.
+/// \tparam HandleLayout a MemHandleLayout, only SmallMemHandleLayout and
+/// WideMemHandleLayout are instantiated (see stack_allocator.cpp)
+/// \tparam Tracking allocation tracking policy (see allocation_tracking.h)
+template<class HandleLayout, class Tracking>
+class BasicStackAllocator {
 public:
+  /// largest capacity the handle layout can address
+  static constexpr std::size_t max_capacity = HandleLayout::max_capacity;
   /****************************************************************************
                                  CONSTRUCTORS
   ****************************************************************************/
   /// \param size_in_bytes
-  explicit StackAllocator(std::size_t size_in_bytes = 0);
+  explicit BasicStackAllocator(std::size_t size_in_bytes = 0);
   /// \param size_in_bytes total memory capacity
   /// \param buffer external allocated memory
-  explicit StackAllocator(std::size_t size_in_bytes, byte *buffer);
+  explicit BasicStackAllocator(std::size_t size_in_bytes, byte *buffer);
   ///
-  ~StackAllocator();
+  ~BasicStackAllocator();
   /****************************************************************************
                                    SIZE
   ****************************************************************************/
@@ -60,8 +82,14 @@ public:
   [[nodiscard]] std::size_t capacityInBytes() const;
   /// \return available size that can be allocated
   [[nodiscard]] std::size_t availableSizeInBytes() const;
+  /// \param ptr
+  /// \return true if ptr points into the stack memory
+  [[nodiscard]] inline bool owns(const void *ptr) const {
+    return ptr >= data_ && ptr < data_ + capacity_;
+  }
   /// All previous data is deleted and markers get invalid
   /// \param size_in_bytes total memory capacity
+  /// \return OUT_OF_BOUNDS if the size can't be addressed by the handle layout
   OdResult resize(std::size_t size_in_bytes);
   /****************************************************************************
                                     ALLOCATION
@@ -80,10 +108,62 @@ public:
     auto handle = allocate(sizeof(T), alignof(T));
     if (!handle.id)
       return handle;
-    T *ptr = reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1));
+    T *ptr = reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id));
     new(ptr) T(std::forward<P>(params)...);
     return handle;
   }
+  /// Thread-safe version of allocate, the marker is bumped with fetch_add
+  /// (or a compare and swap loop when the block needs alignment).
+  /// \note A failed allocation may leave the stack full until the next
+  /// \note freeTo/clear.
+  /// \param block_size_in_bytes
+  /// \param align
+  /// \return handle to the new block, an invalid handle if the stack is full
+  MemHandle allocateConcurrent(std::size_t block_size_in_bytes, std::size_t align = 1);
+  /// Thread-safe version of allocateAligned
+  /// \tparam T
+  /// \tparam P
+  /// \param params
+  /// \return
+  template<typename T, class... P>
+  MemHandle allocateAlignedConcurrent(P &&... params) {
+    auto handle = allocateConcurrent(sizeof(T), alignof(T));
+    if (!handle.id)
+      return handle;
+    new(data_ + HandleLayout::extractMarker(handle.id)) T(std::forward<P>(params)...);
+    return handle;
+  }
+  /// Same as allocateAligned, but the object is destroyed when the stack
+  /// rolls back over it (freeTo/clear)
+  /// \tparam T
+  /// \tparam P
+  /// \param params
+  /// \return
+  template<typename T, class... P>
+  MemHandle allocateTracked(P &&... params) {
+    if constexpr (std::is_trivially_destructible_v<T>)
+      return allocateAligned<T>(std::forward<P>(params)...);
+    else {
+      const auto marker = marker_.load(std::memory_order_relaxed);
+      auto handle = allocateAligned<T>(std::forward<P>(params)...);
+      if (!handle.id)
+        return handle;
+      T *ptr = reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id));
+      auto record_handle = allocate(sizeof(Finalizer), alignof(Finalizer));
+      if (!record_handle.id) {
+        ptr->~T();
+        marker_.store(marker, std::memory_order_relaxed);
+        tracking_.onFreeTo(marker);
+        return {0};
+      }
+      auto *record = reinterpret_cast<Finalizer *>(data_ + HandleLayout::extractMarker(record_handle.id));
+      record->destroy = [](void *object) { reinterpret_cast<T *>(object)->~T(); };
+      record->object = ptr;
+      record->next = finalizers_;
+      finalizers_ = record;
+      return handle;
+    }
+  }
   ///
   /// \tparam T
   /// \param handle
@@ -91,9 +171,9 @@ public:
   /// \return
   template<typename T>
   OdResult set(MemHandle handle, const T &value) {
-    if (handle.id == 0 || handle.id >= capacity_)
+    if (handle.id == 0 || HandleLayout::extractMarker(handle.id) >= capacity_)
       return OdResult::INVALID_INPUT;
-    *reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1)) = value;
+    *reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id)) = value;
     return OdResult::SUCCESS;
   }
   ///
@@ -103,9 +183,9 @@ public:
   /// \return
   template<typename T>
   OdResult set(MemHandle handle, T &&value) {
-    if (handle.id == 0 || handle.id >= capacity_)
+    if (handle.id == 0 || HandleLayout::extractMarker(handle.id) >= capacity_)
       return OdResult::INVALID_INPUT;
-    *reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1)) = std::forward<T>(value);
+    *reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id)) = std::forward<T>(value);
     return OdResult::SUCCESS;
   }
   ///
@@ -114,8 +194,8 @@ public:
   /// \return
   template<typename T>
   T *get(MemHandle handle) {
-    ASSERT(handle.id > 0 && ((handle.id & 0xffffff) - 1) < capacity_)
-    return reinterpret_cast<T *>(data_ + ((handle.id & 0xffffff) - 1));
+    ASSERT(handle.id > 0 && HandleLayout::extractMarker(handle.id) < capacity_)
+    return reinterpret_cast<T *>(data_ + HandleLayout::extractMarker(handle.id));
   }
 
   /// Roll the stack back to a previous marker point
@@ -127,24 +207,38 @@ public:
   /****************************************************************************
                                    DEBUG
   ****************************************************************************/
+  /// \return tracking policy state
+  [[nodiscard]] const Tracking &tracking() const { return tracking_; }
 #ifdef ODYSSEUS_DEBUG
   void dump(std::size_t start = 0, std::size_t size = 0) const;
-  std::vector<ponos::MemoryDumper::Region> getDataRegions();
+  std::vector<ponos::MemoryDumper::Region> getDataRegions() const;
   [[nodiscard]]static std::vector<ponos::MemoryDumper::Region> getRegions();
 #endif
 
 private:
+  /// Stored in the stack, right after the object it destroys
+  struct Finalizer {
+    void (*destroy)(void *);
+    void *object;
+    Finalizer *next;
+  };
+  /// Destroys tracked objects from the chain head down to the given offset
+  /// \param marker
+  void runFinalizers(std::size_t marker);
+
   byte *data_{nullptr};
   std::size_t capacity_{0};
-  std::size_t marker_{0};
+  std::atomic<std::size_t> marker_{0};
   bool using_extern_memory_{false};
-
-#ifdef ODYSSEUS_DEBUG
-  std::vector<std::size_t> db_handles;
-  std::vector<ponos::MemoryDumper::Region> db_regions;
-#endif
+  Tracking tracking_;
+  Finalizer *finalizers_{nullptr};
 };
 
+/// Stack allocator of up to 16 MB
+using StackAllocator = BasicStackAllocator<SmallMemHandleLayout, DefaultTracking>;
+/// Stack allocator for large (> 16 MB) memory blocks
+using WideStackAllocator = BasicStackAllocator<WideMemHandleLayout, DefaultTracking>;
+
 }
 
 #endif //ODYSSEUS_ODYSSEUS_MEMORY_STACK_ALLOCATOR_H
@@ -0,0 +1,326 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file tlsf_allocator.cpp
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#include <odysseus/memory/tlsf_allocator.h>
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace odysseus {
+
+/******************************************************************************
+ *                                 BITS
+******************************************************************************/
+/// \param x non-zero value
+/// \return index of the least significant set bit
+static inline u32 findFirstSet(u32 x) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, x);
+  return index;
+#else
+  return __builtin_ctz(x);
+#endif
+}
+/// \param x non-zero value
+/// \return index of the most significant set bit
+static inline u32 findLastSet(u64 x) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse64(&index, x);
+  return index;
+#else
+  return 63 - __builtin_clzll(x);
+#endif
+}
+/******************************************************************************
+ *                                 BLOCK
+******************************************************************************/
+struct TlsfAllocator::Block {
+  static constexpr std::size_t free_bit = 1;
+  Block *prev_physical;
+  std::size_t size;
+  [[nodiscard]] inline std::size_t payloadSize() const { return size & ~free_bit; }
+  [[nodiscard]] inline bool isFree() const { return size & free_bit; }
+  [[nodiscard]] inline byte *payload() { return reinterpret_cast<byte *>(this) + align_size; }
+  [[nodiscard]] inline Block *next() { return reinterpret_cast<Block *>(payload() + payloadSize()); }
+  static inline Block *fromPayload(const void *ptr) {
+    return reinterpret_cast<Block *>(const_cast<byte *>(reinterpret_cast<const byte *>(ptr)) - align_size);
+  }
+};
+/// free list links, stored in the payload of free blocks
+struct FreeLinks {
+  TlsfAllocator::Block *next;
+  TlsfAllocator::Block *prev;
+};
+static constexpr std::size_t header_size = TlsfAllocator::align_size;
+static constexpr std::size_t min_block_size = TlsfAllocator::align_size;
+static constexpr std::size_t max_block_size = (std::size_t(1) << TlsfAllocator::fl_index_max) - header_size;
+static_assert(sizeof(TlsfAllocator::Block) <= header_size);
+static_assert(sizeof(FreeLinks) <= min_block_size);
+
+static inline FreeLinks *links(TlsfAllocator::Block *block) {
+  return reinterpret_cast<FreeLinks *>(block->payload());
+}
+/******************************************************************************
+ *                                 MAPPING
+******************************************************************************/
+/// Computes the lists that hold blocks of the given size
+static inline void mappingInsert(std::size_t size, u32 &fl, u32 &sl) {
+  if (size < TlsfAllocator::small_block_size) {
+    // small blocks are stored in the first list
+    fl = 0;
+    sl = static_cast<u32>(size / (TlsfAllocator::small_block_size / TlsfAllocator::sl_index_count));
+  } else {
+    fl = findLastSet(size);
+    sl = static_cast<u32>(size >> (fl - TlsfAllocator::sl_index_count_log2)) ^ TlsfAllocator::sl_index_count;
+    fl -= TlsfAllocator::fl_index_shift - 1;
+  }
+}
+/// Computes the first list whose blocks are all large enough for size
+static inline void mappingSearch(std::size_t size, u32 &fl, u32 &sl) {
+  if (size >= TlsfAllocator::small_block_size)
+    size += (std::size_t(1) << (findLastSet(size) - TlsfAllocator::sl_index_count_log2)) - 1;
+  mappingInsert(size, fl, sl);
+}
+/******************************************************************************
+ *                               ALLOCATOR
+******************************************************************************/
+TlsfAllocator::TlsfAllocator(std::size_t size_in_bytes) : capacity_{size_in_bytes} {
+  if (size_in_bytes)
+    data_ = new u8[size_in_bytes];
+  setup();
+}
+
+TlsfAllocator::TlsfAllocator(std::size_t size_in_bytes, byte *buffer) :
+    data_{buffer}, capacity_{size_in_bytes}, using_extern_memory_{true} {
+  setup();
+}
+
+TlsfAllocator::~TlsfAllocator() {
+  if (!using_extern_memory_)
+    delete[] data_;
+}
+
+std::size_t TlsfAllocator::capacityInBytes() const {
+  return capacity_;
+}
+
+std::size_t TlsfAllocator::availableSizeInBytes() const {
+  return available_;
+}
+
+std::size_t TlsfAllocator::blockSizeInBytes(const void *ptr) {
+  return Block::fromPayload(ptr)->payloadSize();
+}
+
+bool TlsfAllocator::owns(const void *ptr) const {
+  return ptr >= data_ && ptr < data_ + capacity_;
+}
+
+void *TlsfAllocator::allocate(std::size_t size_in_bytes, std::size_t align) {
+  if (!size_in_bytes || size_in_bytes > max_block_size)
+    return nullptr;
+  const std::size_t adjusted_size = std::max(mem::alignTo(size_in_bytes, align_size), min_block_size);
+  // over-aligned blocks need room for a leading free block that can be
+  // returned to the lists
+  const std::size_t gap_min = header_size + min_block_size;
+  Block *block = takeFreeBlock(align > align_size ? adjusted_size + align + gap_min : adjusted_size);
+  if (!block)
+    return nullptr;
+  if (align > align_size) {
+    byte *payload = block->payload();
+    std::size_t gap = mem::alignPointer(payload, align) - payload;
+    if (gap && gap < gap_min)
+      gap = mem::alignPointer(payload + gap_min, align) - payload;
+    if (gap) {
+      Block *aligned_block = split(block, gap - header_size);
+      // free blocks never touch each other, the previous block is used
+      insertFreeBlock(block);
+      block = aligned_block;
+    }
+  }
+  // give back the trailing space
+  if (block->payloadSize() >= adjusted_size + header_size + min_block_size)
+    insertFreeBlock(split(block, adjusted_size));
+  return block->payload();
+}
+
+void TlsfAllocator::freeBlock(void *ptr) {
+  if (!ptr)
+    return;
+  ASSERT(owns(ptr))
+  insertFreeBlock(merge(Block::fromPayload(ptr)));
+}
+
+void TlsfAllocator::setup() {
+  byte *start = mem::alignPointer(data_, align_size);
+  if (!data_ || capacity_ < static_cast<std::size_t>(start - data_) + 2 * header_size + min_block_size) {
+    available_ = 0;
+    return;
+  }
+  // leave room for the sentinel
+  std::size_t block_size = capacity_ - (start - data_) - 2 * header_size;
+  block_size = std::min(block_size - block_size % align_size, max_block_size);
+  auto *block = reinterpret_cast<Block *>(start);
+  block->prev_physical = nullptr;
+  block->size = block_size;
+  auto *sentinel = block->next();
+  sentinel->prev_physical = block;
+  sentinel->size = 0;
+  insertFreeBlock(block);
+}
+
+void TlsfAllocator::insertFreeBlock(Block *block) {
+  u32 fl, sl;
+  mappingInsert(block->payloadSize(), fl, sl);
+  Block *head = free_blocks_[fl][sl];
+  links(block)->next = head;
+  links(block)->prev = nullptr;
+  if (head)
+    links(head)->prev = block;
+  free_blocks_[fl][sl] = block;
+  fl_bitmap_ |= 1u << fl;
+  sl_bitmap_[fl] |= 1u << sl;
+  block->size |= Block::free_bit;
+  available_ += block->payloadSize();
+}
+
+void TlsfAllocator::removeFreeBlock(Block *block) {
+  u32 fl, sl;
+  mappingInsert(block->payloadSize(), fl, sl);
+  Block *next = links(block)->next;
+  Block *prev = links(block)->prev;
+  if (next)
+    links(next)->prev = prev;
+  if (prev)
+    links(prev)->next = next;
+  else {
+    free_blocks_[fl][sl] = next;
+    if (!next) {
+      sl_bitmap_[fl] &= ~(1u << sl);
+      if (!sl_bitmap_[fl])
+        fl_bitmap_ &= ~(1u << fl);
+    }
+  }
+  block->size &= ~Block::free_bit;
+  available_ -= block->payloadSize();
+}
+
+TlsfAllocator::Block *TlsfAllocator::takeFreeBlock(std::size_t size_in_bytes) {
+  if (size_in_bytes > max_block_size)
+    return nullptr;
+  u32 fl, sl;
+  mappingSearch(size_in_bytes, fl, sl);
+  if (fl >= fl_index_count)
+    return nullptr;
+  // search the same first level for a large enough list
+  u32 sl_map = sl_bitmap_[fl] & (~0u << sl);
+  if (!sl_map) {
+    // or go to the next non-empty first level
+    const u32 fl_map = fl + 1 < 32 ? fl_bitmap_ & (~0u << (fl + 1)) : 0;
+    if (!fl_map)
+      return nullptr;
+    fl = findFirstSet(fl_map);
+    sl_map = sl_bitmap_[fl];
+  }
+  Block *block = free_blocks_[fl][findFirstSet(sl_map)];
+  removeFreeBlock(block);
+  return block;
+}
+
+TlsfAllocator::Block *TlsfAllocator::split(Block *block, std::size_t size_in_bytes) {
+  auto *remaining = reinterpret_cast<Block *>(block->payload() + size_in_bytes);
+  remaining->size = block->payloadSize() - size_in_bytes - header_size;
+  remaining->prev_physical = block;
+  remaining->next()->prev_physical = remaining;
+  block->size = size_in_bytes;
+  return remaining;
+}
+
+TlsfAllocator::Block *TlsfAllocator::merge(Block *block) {
+  Block *prev = block->prev_physical;
+  if (prev && prev->isFree()) {
+    removeFreeBlock(prev);
+    prev->size += header_size + block->payloadSize();
+    prev->next()->prev_physical = prev;
+    block = prev;
+  }
+  Block *next = block->next();
+  if (next->isFree()) {
+    removeFreeBlock(next);
+    block->size += header_size + next->payloadSize();
+    block->next()->prev_physical = block;
+  }
+  return block;
+}
+
+#ifdef ODYSSEUS_DEBUG
+std::vector<ponos::MemoryDumper::Region> TlsfAllocator::getRegions() {
+  std::vector<ponos::MemoryDumper::Region> regions = {
+      { // data_
+          offsetof(TlsfAllocator, data_),
+          sizeof(data_),
+          1,
+          ponos::ConsoleColors::color(1),
+          {}
+      },
+      { // capacity_
+          offsetof(TlsfAllocator, capacity_),
+          sizeof(capacity_),
+          1,
+          ponos::ConsoleColors::color(2),
+          {}
+      },
+      { // available_
+          offsetof(TlsfAllocator, available_),
+          sizeof(available_),
+          1,
+          ponos::ConsoleColors::color(3),
+          {}
+      },
+      { // bitmaps
+          offsetof(TlsfAllocator, fl_bitmap_),
+          sizeof(fl_bitmap_) + sizeof(sl_bitmap_),
+          1,
+          ponos::ConsoleColors::color(4),
+          {}
+      },
+      { // free_blocks_
+          offsetof(TlsfAllocator, free_blocks_),
+          sizeof(free_blocks_),
+          1,
+          ponos::ConsoleColors::color(5),
+          {}
+      },
+  };
+  return regions;
+}
+#endif
+
+}
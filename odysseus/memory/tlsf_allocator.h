@@ -0,0 +1,134 @@
+/// Copyright (c) 2021, FilipeCN.
+///
+/// The MIT License (MIT)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to
+/// deal in the Software without restriction, including without limitation the
+/// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+/// sell copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+/// IN THE SOFTWARE.
+///
+///\file tlsf_allocator.h
+///\author FilipeCN (filipedecn@gmail.com)
+///\date 2026-10-16
+///
+///\brief
+
+#ifndef ODYSSEUS_ODYSSEUS_MEMORY_TLSF_ALLOCATOR_H
+#define ODYSSEUS_ODYSSEUS_MEMORY_TLSF_ALLOCATOR_H
+
+#include <odysseus/memory/mem.h>
+
+namespace odysseus {
+
+/// RAII Two-Level Segregated Fit Allocator
+/// General purpose allocator of variable size blocks with O(1) allocation
+/// and deallocation. Free blocks are kept in segregated lists indexed by two
+/// levels: the first level splits sizes in powers of two and the second
+/// level splits each power of two range into linear sub-ranges. Two bitmaps
+/// tell which lists are non-empty, so a suitable list is found with a couple
+/// of bit scans. Freed blocks are immediately merged with their free
+/// physical neighbours.
+///
+/// \note Block Layout:
+/// \note Every block starts with a 16 byte header holding a pointer to the
+/// previous physical block and the block size (the lowest bit flags a free
+/// block). Free blocks also store the free list links in their first
+/// payload bytes. Block sizes are multiples of 16 bytes, so payloads are
+/// 16 byte aligned. A zero sized used block sits at the end of the memory
+/// block as a sentinel.
+///
+/// \note This class is not thread-safe.
+class TlsfAllocator {
+public:
+  /****************************************************************************
+                                 CONSTRUCTORS
+  ****************************************************************************/
+  /// \param size_in_bytes
+  explicit TlsfAllocator(std::size_t size_in_bytes = 0);
+  /// \param size_in_bytes total memory capacity
+  /// \param buffer external allocated memory
+  TlsfAllocator(std::size_t size_in_bytes, byte *buffer);
+  ///
+  ~TlsfAllocator();
+  TlsfAllocator(const TlsfAllocator &) = delete;
+  TlsfAllocator &operator=(const TlsfAllocator &) = delete;
+  /****************************************************************************
+                                   SIZE
+  ****************************************************************************/
+  /// \return total memory capacity (in bytes)
+  [[nodiscard]] std::size_t capacityInBytes() const;
+  /// \note Free memory may be fragmented, so this size may not be available
+  /// \note as a single block.
+  /// \return sum of all free block sizes (in bytes)
+  [[nodiscard]] std::size_t availableSizeInBytes() const;
+  /// \param ptr block returned by allocate
+  /// \return usable size of the block (in bytes)
+  [[nodiscard]] static std::size_t blockSizeInBytes(const void *ptr);
+  /// \param ptr
+  /// \return true if ptr lies in this allocator's memory
+  [[nodiscard]] bool owns(const void *ptr) const;
+  /****************************************************************************
+                                    ALLOCATION
+  ****************************************************************************/
+  /// \param size_in_bytes
+  /// \param align power of two alignment
+  /// \return pointer to the allocated block, nullptr if no block fits
+  void *allocate(std::size_t size_in_bytes, std::size_t align = 1);
+  /// \param ptr block returned by allocate (nullptr is ignored)
+  void freeBlock(void *ptr);
+  /****************************************************************************
+                                   DEBUG
+  ****************************************************************************/
+#ifdef ODYSSEUS_DEBUG
+  [[nodiscard]]static std::vector<ponos::MemoryDumper::Region> getRegions();
+#endif
+
+  // mapping parameters
+  static constexpr u32 align_log2 = 4;
+  static constexpr std::size_t align_size = 1u << align_log2;
+  static constexpr u32 sl_index_count_log2 = 5;
+  static constexpr u32 sl_index_count = 1u << sl_index_count_log2;
+  static constexpr u32 fl_index_shift = sl_index_count_log2 + align_log2;
+  static constexpr u32 fl_index_max = 40;
+  static constexpr u32 fl_index_count = fl_index_max - fl_index_shift + 1;
+  static constexpr std::size_t small_block_size = std::size_t(1) << fl_index_shift;
+  /// block header (see Block Layout)
+  struct Block;
+
+private:
+  /// Builds the initial free block (and the sentinel) over data_
+  void setup();
+  void insertFreeBlock(Block *block);
+  void removeFreeBlock(Block *block);
+  /// \return first free block of at least size_in_bytes, removed from lists
+  Block *takeFreeBlock(std::size_t size_in_bytes);
+  /// Splits the block, leaving it with size_in_bytes of payload
+  /// \return the remaining part
+  static Block *split(Block *block, std::size_t size_in_bytes);
+  /// Merges the block with its free physical neighbours
+  Block *merge(Block *block);
+
+  byte *data_{nullptr};
+  std::size_t capacity_{0};
+  std::size_t available_{0};
+  bool using_extern_memory_{false};
+  u32 fl_bitmap_{0};
+  u32 sl_bitmap_[fl_index_count]{};
+  Block *free_blocks_[fl_index_count][sl_index_count]{};
+};
+
+}
+
+#endif //ODYSSEUS_ODYSSEUS_MEMORY_TLSF_ALLOCATOR_H
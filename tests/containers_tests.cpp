@@ -0,0 +1,248 @@
+//
+// Created by filipecn on 16/10/2026.
+//
+#include <catch2/catch.hpp>
+#include <odysseus/containers/object_pool.h>
+#include <odysseus/containers/soa_object_pool.h>
+#include <odysseus/containers/work_stealing_deque.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace odysseus;
+
+TEST_CASE("ObjectPool", "[containers]") {
+  struct Object {
+    explicit Object(int *counter, u64 value) : counter{counter}, value{value} { (*counter)++; }
+    Object(Object &&other) noexcept: counter{other.counter}, value{other.value} { (*counter)++; }
+    ~Object() { (*counter)--; }
+    int *counter;
+    u64 value;
+  };
+  SECTION("sanity") {
+    int counter = 0;
+    {
+      ObjectPool<Object> pool(4);
+      REQUIRE(pool.capacity() == 4);
+      REQUIRE(pool.size() == 0);
+      REQUIRE(pool.sizeInBytes() == 4 * (sizeof(Object) + 3 * sizeof(u32)));
+      ObjectPool<Object>::Handle handles[4];
+      for (u64 i = 0; i < 4; ++i) {
+        handles[i] = pool.allocate(&counter, i);
+        REQUIRE(handles[i].isValid());
+      }
+      REQUIRE(!pool.allocate(&counter, 5).isValid());
+      REQUIRE(counter == 4);
+      for (u64 i = 0; i < 4; ++i)
+        REQUIRE(pool.get(handles[i])->value == i);
+      REQUIRE(pool.destroy(handles[1]) == OdResult::SUCCESS);
+      REQUIRE(counter == 3);
+      REQUIRE(pool.size() == 3);
+    }
+    REQUIRE(counter == 0);
+  }//
+  SECTION("stale handles") {
+    int counter = 0;
+    ObjectPool<Object> pool(2);
+    auto a = pool.allocate(&counter, 1);
+    REQUIRE(pool.isAlive(a));
+    REQUIRE(pool.destroy(a) == OdResult::SUCCESS);
+    REQUIRE(!pool.isAlive(a));
+    REQUIRE(pool.get(a) == nullptr);
+    REQUIRE(pool.destroy(a) == OdResult::INVALID_INPUT);
+    // the slot is recycled, but the old handle stays stale
+    auto b = pool.allocate(&counter, 2);
+    REQUIRE(b.index == a.index);
+    REQUIRE(b.generation != a.generation);
+    REQUIRE(pool.get(a) == nullptr);
+    REQUIRE(pool.get(b)->value == 2);
+    REQUIRE(!pool.isAlive({}));
+  }//
+}
+
+TEST_CASE("ObjectPool dense storage", "[containers]") {
+  SECTION("swap and pop") {
+    ObjectPool<u64> pool(8);
+    ObjectPool<u64>::Handle handles[8];
+    for (u64 i = 0; i < 8; ++i)
+      handles[i] = pool.allocate(i);
+    // live objects are contiguous
+    u64 sum = 0;
+    for (auto &value : pool)
+      sum += value;
+    REQUIRE(sum == 28);
+    REQUIRE(pool.destroy(handles[2]) == OdResult::SUCCESS);
+    REQUIRE(pool.destroy(handles[0]) == OdResult::SUCCESS);
+    REQUIRE(pool.size() == 6);
+    REQUIRE(pool.end() - pool.begin() == 6);
+    sum = 0;
+    for (auto &value : pool)
+      sum += value;
+    REQUIRE(sum == 26);
+    // handles still point to the right (moved) objects
+    for (u64 i = 1; i < 8; ++i)
+      if (i != 2)
+        REQUIRE(*pool.get(handles[i]) == i);
+    // dense positions map back to handles
+    for (u32 i = 0; i < pool.size(); ++i) {
+      auto h = pool.handleAt(i);
+      REQUIRE(pool.get(h) == &pool[i]);
+    }
+    pool.clear();
+    REQUIRE(pool.size() == 0);
+    REQUIRE(!pool.isAlive(handles[7]));
+  }//
+  SECTION("reserve") {
+    ObjectPool<std::string> pool(2);
+    auto a = pool.allocate("a");
+    auto b = pool.allocate("b");
+    REQUIRE(!pool.allocate("c").isValid());
+    REQUIRE(pool.reserve(4) == OdResult::SUCCESS);
+    REQUIRE(pool.capacity() == 4);
+    auto c = pool.allocate("c");
+    auto d = pool.allocate("d");
+    REQUIRE(c.isValid());
+    REQUIRE(d.isValid());
+    REQUIRE(!pool.allocate("e").isValid());
+    REQUIRE(*pool.get(a) == "a");
+    REQUIRE(*pool.get(b) == "b");
+    REQUIRE(*pool.get(c) == "c");
+    pool.destroy(a);
+    pool.destroy(c);
+    REQUIRE(pool.reserve(5) == OdResult::SUCCESS);
+    for (int i = 0; i < 3; ++i)
+      REQUIRE(pool.allocate("x").isValid());
+    REQUIRE(!pool.allocate("y").isValid());
+    REQUIRE(*pool.get(d) == "d");
+  }//
+}
+
+TEST_CASE("SoAObjectPool", "[containers]") {
+  SECTION("layout") {
+    SoAObjectPool<f32, u8, u64> pool(10);
+    REQUIRE(pool.capacity() == 16);
+    pool.allocate(1.f, 1, 1);
+    auto x = pool.field<0>();
+    auto y = pool.field<1>();
+    auto z = pool.field<2>();
+    REQUIRE(x.size == 1);
+    REQUIRE(reinterpret_cast<uintptr_t>(x.data) % mem::cache_l1_size == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(y.data) % mem::cache_l1_size == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(z.data) % mem::cache_l1_size == 0);
+    REQUIRE(reinterpret_cast<byte *>(y.data) >= reinterpret_cast<byte *>(x.data + pool.capacity()));
+    REQUIRE(reinterpret_cast<byte *>(z.data) >= reinterpret_cast<byte *>(y.data + pool.capacity()));
+  }//
+  SECTION("swap and pop") {
+    SoAObjectPool<f32, u32> pool(8);
+    SoAObjectPool<f32, u32>::Handle handles[8];
+    for (u32 i = 0; i < 8; ++i)
+      handles[i] = pool.allocate(static_cast<f32>(i), i);
+    REQUIRE(pool.destroy(handles[2]) == OdResult::SUCCESS);
+    REQUIRE(pool.destroy(handles[2]) == OdResult::INVALID_INPUT);
+    REQUIRE(pool.get<0>(handles[2]) == nullptr);
+    REQUIRE(pool.size() == 7);
+    // fields move together
+    auto x = pool.field<0>();
+    auto id = pool.field<1>();
+    for (u32 i = 0; i < pool.size(); ++i)
+      REQUIRE(x[i] == static_cast<f32>(id[i]));
+    for (u32 i = 0; i < 8; ++i)
+      if (i != 2) {
+        REQUIRE(*pool.get<1>(handles[i]) == i);
+        REQUIRE(*pool.get<0>(handles[i]) == static_cast<f32>(i));
+      }
+    // iterate a single field
+    for (auto &value : pool.field<0>())
+      value *= 2.f;
+    REQUIRE(*pool.get<0>(handles[7]) == 14.f);
+    pool.clear();
+    REQUIRE(pool.size() == 0);
+    REQUIRE(!pool.isAlive(handles[0]));
+  }//
+  SECTION("reserve") {
+    SoAObjectPool<u32, f64> pool(1);
+    std::vector<SoAObjectPool<u32, f64>::Handle> handles;
+    for (u32 i = 0; i < 16; ++i)
+      handles.emplace_back(pool.allocate(i, i * 0.5));
+    REQUIRE(!pool.allocate(0u, 0.0).isValid());
+    REQUIRE(pool.reserve(17) == OdResult::SUCCESS);
+    REQUIRE(pool.capacity() == 32);
+    REQUIRE(pool.allocate(16u, 8.0).isValid());
+    for (u32 i = 0; i < 16; ++i) {
+      REQUIRE(*pool.get<0>(handles[i]) == i);
+      REQUIRE(*pool.get<1>(handles[i]) == i * 0.5);
+    }
+  }//
+}
+
+TEST_CASE("WorkStealingDeque", "[containers]") {
+  SECTION("sanity") {
+    WorkStealingDeque<u32> deque(6, mem::ContextType::HEAP);
+    REQUIRE(deque.capacity() == 8);
+    REQUIRE(deque.empty());
+    u32 item = 0;
+    REQUIRE(!deque.pop(item));
+    REQUIRE(!deque.steal(item));
+    for (u32 i = 0; i < 8; ++i)
+      REQUIRE(deque.push(i));
+    REQUIRE(!deque.push(8));
+    REQUIRE(deque.size() == 8);
+    // owner pops the newest items
+    REQUIRE(deque.pop(item));
+    REQUIRE(item == 7);
+    // thieves steal the oldest
+    REQUIRE(deque.steal(item));
+    REQUIRE(item == 0);
+    REQUIRE(deque.steal(item));
+    REQUIRE(item == 1);
+    REQUIRE(deque.size() == 5);
+    // freed slots are reused
+    REQUIRE(deque.push(10));
+    REQUIRE(deque.push(11));
+    REQUIRE(deque.push(12));
+    REQUIRE(!deque.push(13));
+    u32 expected[] = {12, 11, 10, 6, 5, 4, 3, 2};
+    for (u32 e : expected) {
+      REQUIRE(deque.pop(item));
+      REQUIRE(item == e);
+    }
+    REQUIRE(!deque.pop(item));
+    REQUIRE(deque.empty());
+  }//
+  SECTION("concurrent steal") {
+    const u32 item_count = 100000;
+    const u32 thief_count = 3;
+    WorkStealingDeque<u32> deque(256, mem::ContextType::HEAP);
+    std::vector<std::atomic<u32>> taken(item_count);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> thieves;
+    for (u32 t = 0; t < thief_count; ++t)
+      thieves.emplace_back([&]() {
+        u32 item = 0;
+        while (!done.load())
+          if (deque.steal(item))
+            taken[item].fetch_add(1);
+      });
+    u32 item = 0;
+    for (u32 i = 0; i < item_count;) {
+      if (deque.push(i)) {
+        ++i;
+        continue;
+      }
+      // full, consume some items as the owner
+      if (deque.pop(item))
+        taken[item].fetch_add(1);
+    }
+    while (deque.pop(item))
+      taken[item].fetch_add(1);
+    done.store(true);
+    for (auto &thief : thieves)
+      thief.join();
+    // every item was taken exactly once, by the owner or by a thief
+    u32 wrong = 0;
+    for (auto &t : taken)
+      wrong += t.load() != 1;
+    REQUIRE(wrong == 0);
+  }//
+}
@@ -0,0 +1,58 @@
+//
+// Created by filipecn on 16/10/2026.
+//
+#include <catch2/catch.hpp>
+#include <odysseus/debug/profiler.h>
+#include <chrono>
+#include <thread>
+
+using namespace odysseus;
+
+TEST_CASE("Profiler", "[debug]") {
+  SECTION("not initialized") {
+    { ODYSSEUS_PROFILE_ZONE("ignored"); }
+    REQUIRE(Profiler::eventCount(0) == 0);
+  }//
+  SECTION("zones") {
+    REQUIRE(Profiler::init(2, 8, mem::ContextType::HEAP) == OdResult::SUCCESS);
+    REQUIRE(Profiler::ticksPerMicrosecond() > 0);
+    {
+      ODYSSEUS_PROFILE_ZONE("outer");
+      {
+        ODYSSEUS_PROFILE_ZONE("inner");
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+    REQUIRE(Profiler::eventCount(0) == 2);
+    // inner zones finish first
+    auto inner = Profiler::event(0, 0);
+    auto outer = Profiler::event(0, 1);
+    REQUIRE(std::string(inner.name) == "inner");
+    REQUIRE(std::string(outer.name) == "outer");
+    REQUIRE(inner.depth == 1);
+    REQUIRE(outer.depth == 0);
+    REQUIRE(outer.begin <= inner.begin);
+    REQUIRE(inner.end <= outer.end);
+    REQUIRE(static_cast<f64>(inner.end - inner.begin) / Profiler::ticksPerMicrosecond() >= 50.);
+    // second thread
+    std::thread([]() {
+      mem::setThreadIndex(1);
+      ODYSSEUS_PROFILE_FUNCTION();
+    }).join();
+    REQUIRE(Profiler::eventCount(1) == 1);
+    auto json = Profiler::chromeTrace();
+    REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"inner\"") != std::string::npos);
+    REQUIRE(json.find("\"tid\":1") != std::string::npos);
+    // ring buffer keeps the newest events
+    Profiler::reset();
+    const char *names[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+    for (auto name : names)
+      ODYSSEUS_PROFILE_ZONE(name);
+    REQUIRE(Profiler::eventCount(0) == 8);
+    REQUIRE(std::string(Profiler::event(0, 0).name) == "2");
+    REQUIRE(std::string(Profiler::event(0, 7).name) == "9");
+    Profiler::release();
+    REQUIRE(Profiler::eventCount(0) == 0);
+  }//
+}
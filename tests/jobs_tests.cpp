@@ -0,0 +1,311 @@
+//
+// Created by filipecn on 16/10/2026.
+//
+#include <catch2/catch.hpp>
+#include <odysseus/jobs/job_system.h>
+#include <odysseus/jobs/task_graph.h>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+using namespace odysseus;
+
+TEST_CASE("JobSystem", "[jobs]") {
+  SECTION("sanity") {
+    REQUIRE(JobSystem::init(4, 1024, 64, false, mem::ContextType::HEAP) == OdResult::SUCCESS);
+    REQUIRE(JobSystem::workerCount() == 4);
+    std::atomic<u32> counter{0};
+    Job *root = JobSystem::create([&]() { counter.fetch_add(1); });
+    REQUIRE(root);
+    for (u32 i = 0; i < 32; ++i) {
+      Job *child = JobSystem::create([&]() { counter.fetch_add(1); }, root);
+      REQUIRE(child);
+      JobSystem::run(child);
+    }
+    JobSystem::run(root);
+    JobSystem::wait(root);
+    REQUIRE(counter.load() == 33);
+    JobSystem::release();
+    REQUIRE(JobSystem::workerCount() == 0);
+  }//
+  SECTION("nested jobs") {
+    REQUIRE(JobSystem::init(4, 1024, 256, false, mem::ContextType::HEAP) == OdResult::SUCCESS);
+    std::atomic<u32> counter{0};
+    Job *root = JobSystem::create([]() {});
+    for (u32 i = 0; i < 8; ++i) {
+      // children create their own children
+      JobSystem::run(JobSystem::create([&counter, root]() {
+        for (u32 j = 0; j < 8; ++j)
+          JobSystem::run(JobSystem::create([&counter]() { counter.fetch_add(1); }, root));
+      }, root));
+    }
+    JobSystem::run(root);
+    JobSystem::wait(root);
+    REQUIRE(counter.load() == 64);
+    JobSystem::release();
+  }//
+  SECTION("job record limit") {
+    REQUIRE(JobSystem::init(1, 0, 4, false, mem::ContextType::HEAP) == OdResult::SUCCESS);
+    u32 counter = 0;
+    Job *root = JobSystem::create([]() {});
+    for (u32 i = 0; i < 3; ++i)
+      JobSystem::run(JobSystem::create([&]() { ++counter; }, root));
+    // no more job records
+    REQUIRE(JobSystem::create([]() {}, root) == nullptr);
+    JobSystem::run(root);
+    JobSystem::wait(root);
+    REQUIRE(counter == 3);
+    JobSystem::release();
+  }//
+  SECTION("scratch arenas") {
+    REQUIRE(JobSystem::init(4, 1024, 64, false, mem::ContextType::HEAP) == OdResult::SUCCESS);
+    std::atomic<u32> failures{0};
+    Job *root = JobSystem::create([]() {});
+    for (u32 i = 0; i < 64; ++i)
+      JobSystem::run(JobSystem::create([&failures, i]() {
+        auto &scratch = JobSystem::scratch();
+        // outermost jobs start with an empty arena
+        if (scratch.availableSizeInBytes() != scratch.capacityInBytes())
+          failures.fetch_add(1);
+        auto handle = scratch.allocate(512);
+        if (!handle.id)
+          failures.fetch_add(1);
+        else
+          std::memset(scratch.get<byte>(handle), static_cast<int>(i), 512);
+      }, root));
+    JobSystem::run(root);
+    JobSystem::wait(root);
+    REQUIRE(failures.load() == 0);
+    REQUIRE(JobSystem::scratch(0).availableSizeInBytes() == 1024);
+    JobSystem::release();
+  }//
+  SECTION("parallel for") {
+    REQUIRE(JobSystem::init(4, 1024, 256, false, mem::ContextType::HEAP) == OdResult::SUCCESS);
+    REQUIRE(JobSystem::grainSize(10000) == 10000 / 32);
+    REQUIRE(JobSystem::grainSize(3) == 1);
+    std::vector<u32> values(10000, 0);
+    JobSystem::parallelFor(0, 10000, [&](u32 i) { values[i] += i; });
+    u32 wrong = 0;
+    for (u32 i = 0; i < 10000; ++i)
+      wrong += values[i] != i;
+    REQUIRE(wrong == 0);
+    // explicit grain, sub range
+    std::atomic<u64> sum{0};
+    JobSystem::parallelFor(100, 1100, [&](u32 i) { sum.fetch_add(i); }, 7);
+    REQUIRE(sum.load() == (100 + 1099) * 1000 / 2);
+    // empty range
+    JobSystem::parallelFor(5, 5, [&](u32) { sum.store(0); });
+    REQUIRE(sum.load() != 0);
+    // workers participate
+    std::vector<std::atomic<u32>> per_worker(4);
+    std::atomic<bool> stolen{false};
+    JobSystem::parallelFor(0, 100000, [&](u32) {
+      per_worker[mem::threadIndex()].fetch_add(1, std::memory_order_relaxed);
+      if (mem::threadIndex())
+        stolen.store(true, std::memory_order_relaxed);
+      else if (!stolen.load(std::memory_order_relaxed))
+        // give the other workers a chance to run on machines with few cores
+        std::this_thread::yield();
+    });
+    u32 total = 0;
+    u32 busy_workers = 0;
+    for (auto &count : per_worker) {
+      total += count.load();
+      busy_workers += count.load() != 0;
+    }
+    REQUIRE(total == 100000);
+    REQUIRE(busy_workers >= 2);
+    JobSystem::release();
+  }//
+  SECTION("parallel for object pool") {
+#ifdef __linux__
+    cpu_set_t original_cpu_set;
+    REQUIRE(!pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &original_cpu_set));
+#endif
+    REQUIRE(JobSystem::init(3, 0, 128, true, mem::ContextType::HEAP) == OdResult::SUCCESS);
+#ifdef __linux__
+    // the calling thread is worker 0
+    cpu_set_t cpu_set;
+    REQUIRE(!pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set));
+    REQUIRE(CPU_COUNT(&cpu_set) == 1);
+    REQUIRE(CPU_ISSET(0, &cpu_set));
+#endif
+    struct Particle {
+      f32 position;
+      f32 velocity;
+    };
+    ObjectPool<Particle> particles(1000);
+    std::vector<ObjectPool<Particle>::Handle> handles;
+    for (u32 i = 0; i < 1000; ++i)
+      handles.emplace_back(particles.allocate(Particle{0.f, static_cast<f32>(i)}));
+    for (u32 i = 0; i < 1000; i += 2)
+      particles.destroy(handles[i]);
+    JobSystem::parallelFor(particles, [](Particle &p) { p.position += p.velocity; });
+    for (u32 i = 1; i < 1000; i += 2)
+      REQUIRE(particles.get(handles[i])->position == static_cast<f32>(i));
+    JobSystem::release();
+#ifdef __linux__
+    // release restores the affinity of the calling thread
+    REQUIRE(!pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set));
+    REQUIRE(CPU_EQUAL(&cpu_set, &original_cpu_set));
+#endif
+  }//
+  SECTION("re-init") {
+    for (u32 k = 0; k < 4; ++k) {
+      REQUIRE(JobSystem::init(k + 1, 256, 32, false, mem::ContextType::HEAP) == OdResult::SUCCESS);
+      std::atomic<u32> counter{0};
+      JobSystem::parallelFor(0, 1000, [&](u32) { counter.fetch_add(1); });
+      REQUIRE(counter.load() == 1000);
+    }
+    JobSystem::release();
+  }
+}
+
+TEST_CASE("TaskGraph", "[jobs]") {
+  enum Resource : u32 {
+    TRANSFORMS,
+    SKELETONS,
+    AGENTS,
+    SOUNDS,
+    RENDER_LIST,
+  };
+  SECTION("schedule") {
+    TaskGraph graph(16, mem::ContextType::HEAP);
+    REQUIRE(graph.capacity() == 16);
+    auto input = graph.addTask("input", {}, {TRANSFORMS}, []() {});
+    auto animation = graph.addTask("animation", {TRANSFORMS}, {SKELETONS}, []() {});
+    auto ai = graph.addTask("ai", {TRANSFORMS}, {AGENTS}, []() {});
+    auto audio = graph.addTask("audio", {TRANSFORMS}, {SOUNDS}, []() {});
+    auto physics = graph.addTask("physics", {AGENTS}, {TRANSFORMS}, []() {});
+    auto render = graph.addTask("render", {TRANSFORMS, SKELETONS}, {RENDER_LIST}, []() {});
+    REQUIRE(graph.taskCount() == 6);
+    REQUIRE(graph.needsCompile());
+    REQUIRE(graph.compile() == OdResult::SUCCESS);
+    REQUIRE(!graph.needsCompile());
+    REQUIRE(graph.compileCount() == 1);
+    // animation, ai and audio only read what input writes
+    REQUIRE(graph.dependencyCount(input) == 0);
+    REQUIRE(graph.dependencyCount(animation) == 1);
+    REQUIRE(graph.dependencyCount(ai) == 1);
+    REQUIRE(graph.dependencyCount(audio) == 1);
+    REQUIRE(graph.level(animation) == 1);
+    REQUIRE(graph.level(ai) == 1);
+    REQUIRE(graph.level(audio) == 1);
+    // physics writes transforms: after input (writer) and all readers, ai
+    // is linked once even if it also writes agents
+    REQUIRE(graph.dependencyCount(physics) == 4);
+    REQUIRE(graph.level(physics) == 2);
+    // render reads the transforms physics wrote and the animation skeletons
+    REQUIRE(graph.dependencyCount(render) == 2);
+    REQUIRE(graph.level(render) == 3);
+    REQUIRE(graph.levelCount() == 4);
+    // schedule is sorted by level
+    u32 previous_level = 0;
+    for (u32 i = 0; i < graph.taskCount(); ++i) {
+      auto id = graph.scheduledTask(i);
+      REQUIRE(graph.isAlive(id));
+      REQUIRE(graph.level(id) >= previous_level);
+      previous_level = graph.level(id);
+    }
+    REQUIRE(!graph.scheduledTask(6).isValid());
+    // invalid resources and full graph
+    REQUIRE(!graph.addTask("bad", {TaskGraph::max_resource_count}, {}, []() {}).isValid());
+    REQUIRE(!graph.needsCompile());
+    for (u32 i = 0; i < 10; ++i)
+      REQUIRE(graph.addTask("filler", {}, {}, []() {}).isValid());
+    REQUIRE(!graph.addTask("full", {}, {}, []() {}).isValid());
+    REQUIRE(graph.needsCompile());
+    REQUIRE(!graph.scheduledTask(0).isValid());
+  }//
+  SECTION("remove") {
+    TaskGraph graph(4, mem::ContextType::HEAP);
+    u32 counter = 0;
+    auto a = graph.addTask("a", {}, {TRANSFORMS}, [&]() { counter += 1; });
+    auto b = graph.addTask("b", {TRANSFORMS}, {}, [&]() { counter += 10; });
+    REQUIRE(graph.run() == OdResult::SUCCESS);
+    REQUIRE(counter == 11);
+    REQUIRE(graph.dependencyCount(b) == 1);
+    REQUIRE(graph.removeTask(a) == OdResult::SUCCESS);
+    REQUIRE(graph.removeTask(a) == OdResult::INVALID_INPUT);
+    REQUIRE(!graph.isAlive(a));
+    REQUIRE(graph.needsCompile());
+    REQUIRE(graph.run() == OdResult::SUCCESS);
+    REQUIRE(counter == 21);
+    REQUIRE(graph.dependencyCount(b) == 0);
+    REQUIRE(graph.compileCount() == 2);
+    // slot reuse doesn't revive old ids
+    auto c = graph.addTask("c", {}, {}, [&]() { counter += 100; });
+    REQUIRE(c.index == a.index);
+    REQUIRE(!graph.isAlive(a));
+    graph.clear();
+    REQUIRE(graph.taskCount() == 0);
+    REQUIRE(graph.run() == OdResult::SUCCESS);
+    REQUIRE(counter == 21);
+  }//
+  SECTION("serial frames") {
+    // no job system: tasks run in schedule order on the calling thread
+    TaskGraph graph(8, mem::ContextType::HEAP);
+    std::string log;
+    graph.addTask("c", {SKELETONS}, {}, [&]() { log += 'c'; });
+    graph.addTask("a", {}, {SKELETONS}, [&]() { log += 'a'; });
+    graph.addTask("b", {SKELETONS}, {}, [&]() { log += 'b'; });
+    graph.addTask("d", {}, {SKELETONS}, [&]() { log += 'd'; });
+    for (u32 frame = 0; frame < 3; ++frame)
+      REQUIRE(graph.run() == OdResult::SUCCESS);
+    REQUIRE(log == "cabdcabdcabd");
+    REQUIRE(graph.compileCount() == 1);
+  }//
+  SECTION("parallel frames") {
+    REQUIRE(JobSystem::init(4, 0, 64, false, mem::ContextType::HEAP) == OdResult::SUCCESS);
+    TaskGraph graph(16, mem::ContextType::HEAP);
+    std::mutex mutex;
+    std::vector<std::string> log;
+    auto record = [&](const char *name) {
+      std::lock_guard<std::mutex> lock(mutex);
+      log.emplace_back(name);
+    };
+    std::atomic<u32> running{0};
+    std::atomic<u32> max_running{0};
+    auto parallel = [&](const char *name) {
+      const u32 now = running.fetch_add(1) + 1;
+      u32 max = max_running.load();
+      while (now > max && !max_running.compare_exchange_weak(max, now)) {}
+      record(name);
+      // give the other independent tasks time to start
+      for (u32 i = 0; i < 200 && max_running.load() < 3; ++i)
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      running.fetch_sub(1);
+    };
+    u64 transform_sum = 0;
+    graph.addTask("input", {}, {TRANSFORMS}, [&]() { record("input"); transform_sum = 1; });
+    graph.addTask("animation", {TRANSFORMS}, {SKELETONS}, [&]() { parallel("animation"); });
+    graph.addTask("ai", {TRANSFORMS}, {AGENTS}, [&]() { parallel("ai"); });
+    graph.addTask("audio", {TRANSFORMS}, {SOUNDS}, [&]() { parallel("audio"); });
+    graph.addTask("physics", {AGENTS}, {TRANSFORMS}, [&]() {
+      record("physics");
+      transform_sum += 1;
+    });
+    graph.addTask("render", {TRANSFORMS, SKELETONS}, {RENDER_LIST}, [&]() {
+      record("render");
+      transform_sum *= 10;
+    });
+    for (u32 frame = 0; frame < 20; ++frame) {
+      log.clear();
+      REQUIRE(graph.run() == OdResult::SUCCESS);
+      REQUIRE(log.size() == 6);
+      REQUIRE(log[0] == "input");
+      REQUIRE(log[4] == "physics");
+      REQUIRE(log[5] == "render");
+      REQUIRE(transform_sum == 20);
+    }
+    REQUIRE(graph.compileCount() == 1);
+    // independent systems overlapped
+    REQUIRE(max_running.load() > 1);
+    JobSystem::release();
+  }//
+}